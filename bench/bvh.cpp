@@ -0,0 +1,78 @@
+// Times Bvh::distance against a linear scan over the same primitives, on packs of simd_width
+// points, for growing numbers of primitives. Built for the machine it runs on by make bench.
+#include "../src/isa/system_headers.hpp"
+#include <chrono>
+#include <cstdio>
+
+namespace bench {
+#include "../src/app.hpp"
+
+// spheres and boxes as in the crowd scene, over a square growing with their number so that
+// they keep the crowd's density
+std::vector<Primitive> scatter(size_t count, PCG32& rng) {
+    const float side = 40.0f * std::sqrt(count / 512.0f);
+    std::vector<Primitive> primitives;
+    for (size_t i = 0; i < count; i++) {
+        const float size = 0.2f + 0.3f * rng.next(1000) / 1000.0f;
+        const vec3 center(side * rng.next(10000) / 10000.0f, size + rng.next(100) / 100.0f, side * rng.next(10000) / 10000.0f);
+        primitives.push_back(i % 2 ? Primitive::sphere(center, size) : Primitive::box(center, vec3(size)));
+    }
+    return primitives;
+}
+
+vec<simd_width> linear_distance(const std::vector<Primitive>& primitives, const vecpack<simd_width, 3>& p) {
+    vec<simd_width> d(Bvh::max_distance);
+    for (const Primitive& primitive : primitives) d = min(d, primitive.distance(p));
+    return d;
+}
+
+// microseconds per pack of f over the points, which it returns the distances of
+template<typename F>
+double time_packs(const std::vector<vecpack<simd_width, 3>>& points, std::vector<vec<simd_width>>& distances, F f) {
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < points.size(); i++) distances[i] = f(points[i]);
+    const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / points.size();
+}
+
+int run() {
+    constexpr size_t num_packs = 20000;
+    PCG32 rng(42);
+
+    std::printf("%d lanes, %zu packs of points per count\n", int(simd_width), num_packs);
+    std::printf("%8s %12s %12s %10s\n", "n", "bvh (us)", "linear (us)", "mismatches");
+
+    for (size_t n = 16; n <= 16384; n *= 4) {
+        const std::vector<Primitive> primitives = scatter(n, rng);
+        const Bvh bvh(primitives);
+        const float side = 40.0f * std::sqrt(n / 512.0f);
+
+        // the lanes of a pack are within a unit cube, as the points of neighbouring rays
+        std::vector<vecpack<simd_width, 3>> points(num_packs);
+        for (auto& p : points) {
+            const vec3 corner(side * rng.next(10000) / 10000.0f, 2.0f * rng.next(10000) / 10000.0f, side * rng.next(10000) / 10000.0f);
+            std::array<float, simd_width> x, y, z;
+            for (size_t i = 0; i < simd_width; i++) {
+                x[i] = corner[0] + rng.next(10000) / 10000.0f;
+                y[i] = corner[1] + rng.next(10000) / 10000.0f;
+                z[i] = corner[2] + rng.next(10000) / 10000.0f;
+            }
+            p = vecpack<simd_width, 3>({ vec<simd_width>(x), vec<simd_width>(y), vec<simd_width>(z) });
+        }
+
+        std::vector<vec<simd_width>> bvh_distances(num_packs), linear_distances(num_packs);
+        const double bvh_time = time_packs(points, bvh_distances, [&](const vecpack<simd_width, 3>& p) { return bvh.distance(p); });
+        const double linear_time = time_packs(points, linear_distances, [&](const vecpack<simd_width, 3>& p) { return linear_distance(primitives, p); });
+
+        // both take the min of the same distances, which is exact
+        size_t mismatches = 0;
+        for (size_t i = 0; i < num_packs; i++) mismatches += count(~(bvh_distances[i] == linear_distances[i]));
+
+        std::printf("%8zu %12.2f %12.2f %10zu\n", n, bvh_time, linear_time, mismatches);
+    }
+
+    return EXIT_SUCCESS;
+}
+}
+
+int main() { return bench::run(); }
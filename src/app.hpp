@@ -0,0 +1,251 @@
+#ifndef APP_HPP
+#define APP_HPP
+
+// The whole program, compiled once per instruction set by the translation units in isa/,
+// each wrapping it in its own namespace. The system headers must be included beforehand,
+// see isa/system_headers.hpp.
+
+#include <cmath>
+#include <tuple>
+#include <iostream>
+#include <iomanip>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// the scalar math functions of the global namespace, which the vec overloads
+// declared within the instruction set namespaces would otherwise hide
+using ::abs;
+using ::atan2;
+using ::cos;
+using ::exp;
+using ::floor;
+using ::pow;
+using ::sin;
+using ::sqrt;
+
+#include "distances.hpp"
+#include "transformations.hpp"
+#include "linalg/mat3.hpp"
+#include "linalg/vec.hpp"
+#include "linalg/vecpack.hpp"
+
+#include "screen.hpp"
+#include "scenes/simple_scene.hpp"
+#include "scenes/cooler_scene.hpp"
+#include "scenes/crowd_scene.hpp"
+#include "scenes/city_scene.hpp"
+#include "camera.hpp"
+#include "painter.hpp"
+#include "shader.hpp"
+#include "controls.hpp"
+#include "depth_cache.hpp"
+#include "performance_monitor.hpp"
+#include "resolution_controller.hpp"
+#include "thread_pool.hpp"
+
+
+#define SIMD
+#define MULTITHREADED
+#define TILED
+// reprojected start distances are a guess which may step over surfaces, see DepthCache
+// #define REPROJECT
+#define REFINE
+#define CONE_PREPASS
+#define INTERVAL_CULLING
+#define DYNAMIC_RESOLUTION
+
+// the shader and the painters are compiled for the scene, see Shader,
+// which may be picked at build time, e.g. with make SCENE=CrowdScene
+#ifndef SCENE
+#define SCENE CoolerScene
+#endif
+using RenderedScene = SCENE;
+using ScenePainter = Painter<Shader<RenderedScene>>;
+
+// progressive painters keep sampling their band until the program quits,
+// tiled painters are driven frame by frame through the thread pool
+void painter_thread(ScenePainter* painter, const std::atomic<bool>* quit) {
+    while (!*quit) {
+        #ifdef SIMD
+        painter->paint_simd(8000 / simd_width);
+        #else
+        painter->paint(8000);
+        #endif
+    }
+}
+
+int run(int argc, char** argv) {
+    // window size, frames may be rendered at a lower resolution and upscaled to it
+    constexpr auto dimx = 1280u, dimy = 720u;
+    const vec2 dim(dimx, dimy);
+
+    const float walk_speed = 0.2f;
+    const float turn_speed = 0.05f;
+    vec3 walk_dir;
+
+    ShaderConfig shader_config;    
+    shader_config.max_dist = 10000.0f;
+    shader_config.max_its = 256;
+    shader_config.relaxation = 1.4f;
+    shader_config.light_dir = normalize(vec3(-0.2, 0.2, 0));
+    shader_config.background_color = vec3(0.4,0.56,0.97);
+    shader_config.time = 0.0f;
+
+    RenderedScene scene;
+
+    // tiled painters complete whole frames, which are presented without tearing
+    #ifdef TILED
+    Screen screen(dimx, dimy, true);
+    #else
+    Screen screen(dimx, dimy, false);
+    #endif
+    Camera camera(45.0f, dim, vec3(0.0, 1.0, 0.0), -M_PI);
+    Shader<RenderedScene> shader(&shader_config, &camera, &scene);
+    ScenePainter painter(&screen, &shader);
+    #ifdef TILED
+    static_assert(dimx % ScenePainter::width_multiple == 0, "the screen width must be a multiple of the painter's width multiple");
+    #endif
+    PerformanceMonitor perf(2);
+    controles_state state;
+
+    // only the simd tile painters make use of the last frame's depths
+    #if defined(SIMD) && defined(TILED) && defined(REPROJECT)
+    DepthCache depth_cache(dimx, dimy, camera);
+    painter.set_depth_cache(&depth_cache);
+    #endif
+
+    #if defined(SIMD) && defined(TILED) && defined(CONE_PREPASS)
+    painter.set_cone_prepass(true);
+    #endif
+
+    #if defined(SIMD) && defined(TILED) && defined(INTERVAL_CULLING)
+    painter.set_interval_culling(true);
+    #endif
+    
+    #ifdef SIMD
+    const char* title = "SIMD implementation";
+    #else
+    const char* title = "Reference implementation";
+    #endif
+
+    if (!screen.initialize(title)) return -1;
+
+    std::cout << "RUNNING: " << title << std::endl;
+    
+    #ifdef MULTITHREADED
+    // the number of render threads can be given as first argument, defaults to one per core
+    const size_t num_threads = argc > 1 ? std::max(1, atoi(argv[1])) : std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "THREADS: " << num_threads << std::endl;
+
+    #ifdef TILED
+    ThreadPool pool(num_threads);
+    #else
+    std::atomic<bool> quit(false);
+    std::vector<std::unique_ptr<ScenePainter>> painters;
+    std::vector<std::thread> painter_threads;
+
+    // one band per thread, of at least a row
+    const size_t num_bands = std::min<size_t>(num_threads, dimy);
+    for (size_t i = 0; i < num_bands; i++) {
+        painters.push_back(std::make_unique<ScenePainter>(&screen, &shader, i * dimy / num_bands, (i + 1) * dimy / num_bands, PixelOrder::r2));
+        painter_threads.emplace_back(painter_thread, painters.back().get(), &quit);
+    }
+    #endif
+    #endif
+
+    // tiled frames shade one pixel per stride x stride block
+    size_t stride = 1;
+
+    // the render resolution follows the frame times to hold 60 fps, only tiled frames can change resolution
+    #if defined(TILED) && defined(DYNAMIC_RESOLUTION)
+    ResolutionController resolution(dimx, dimy, 0.0166f, ScenePainter::width_multiple);
+    #endif
+
+    while(!state.quit) {
+        poll_state(state);
+
+        camera.turn((state.left - state.right) * turn_speed);
+
+        walk_dir = vec3(0, 0, (state.down - state.up) * walk_speed);
+        camera.move_forward(walk_dir);
+        scene.set_viewpoint(camera.position);
+
+        // coarse-to-fine refinement: a moving camera gets 1/16th of the pixels shaded,
+        // once it stops the next frames are painted at 1/4th and then at full resolution
+        #ifdef REFINE
+        const bool camera_moved = state.left || state.right || state.up || state.down;
+        stride = camera_moved ? ScenePainter::max_stride : std::max<size_t>(1, stride / 2);
+        #endif
+
+        #if defined(MULTITHREADED) && !defined(TILED)
+        screen.sleep(18);
+        shader_config.time += 18;
+
+        screen.render();
+        #elif defined(MULTITHREADED)
+        perf.tick();
+
+        #if defined(SIMD) && defined(REPROJECT)
+        depth_cache.begin_frame(camera, &pool);
+        #endif
+
+        // frame N is painted into the back buffer while frame N-1 is presented,
+        // the camera and shader config are only touched once the workers are done
+        #ifdef SIMD
+        painter.dispatch_frame_simd(&pool, stride);
+        #else
+        painter.dispatch_frame(&pool, stride);
+        #endif
+
+        screen.render();
+        pool.wait();
+        screen.swap_buffers();
+
+        const float frame_seconds = perf.tock();
+        shader_config.time += frame_seconds;
+        #else
+        perf.tick();
+
+        #if defined(SIMD) && defined(TILED) && defined(REPROJECT)
+        depth_cache.begin_frame(camera);
+        #endif
+
+        #if defined(TILED) && defined(SIMD)
+        painter.paint_frame_simd(stride);
+        #elif defined(TILED)
+        painter.paint_frame(stride);
+        #elif defined(SIMD)
+        painter.paint_simd(8000 / simd_width);
+        #else
+        painter.paint(8000);
+        #endif
+        
+        const float frame_seconds = perf.tock();
+        shader_config.time += frame_seconds;
+
+        screen.swap_buffers();
+        screen.render();
+        #endif
+
+        // coarse frames are cheaper than their resolution suggests and are left out of the measure
+        #if defined(TILED) && defined(DYNAMIC_RESOLUTION)
+        if (stride == 1 && resolution.update(frame_seconds)) {
+            screen.set_render_size(resolution.width(), resolution.height());
+            camera.set_screen_dim(vec2(resolution.width(), resolution.height()));
+        }
+        #endif
+    }
+
+    #if defined(MULTITHREADED) && !defined(TILED)
+    quit = true;
+    for (auto& thread : painter_threads) thread.join();
+    #endif
+
+    return EXIT_SUCCESS;
+}
+
+#endif
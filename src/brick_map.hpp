@@ -0,0 +1,238 @@
+#ifndef BRICK_MAP_HPP
+#define BRICK_MAP_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "linalg/vec.hpp"
+#include "linalg/vecpack.hpp"
+#include "linalg/dual.hpp"
+#include "linalg/interval.hpp"
+#include "thread_pool.hpp"
+
+// A static distance field baked over a box. The box is split into cells of cell_voxels^3
+// voxels; the cells the surface may cross hold a brick of brick_size^3 samples, which are
+// interpolated trilinearly, the others only the distance at their center c, from which the
+// distance at p is bounded by d(c) - |p - c|. Sampling costs a few gathers whatever the field.
+//
+// The bricks are not a bound: the interpolated distance is within sqrt(3) / 2 spacing of the
+// field's, and up to sqrt(3) times as steep across a voxel. Rays may then step a little past
+// the baked surfaces, which shows at silhouettes and through features thinner than a voxel.
+//
+// Cell indices and sample offsets are gathered as floats, the map holds at most 2^24 cells and
+// 2^24 samples, i.e. 32768 bricks. The constructor doubles the spacing until the map fits.
+class BrickMap {
+    public:
+    // samples field(p) every spacing units over [lo, hi], or coarser if that does not fit,
+    // spreading the work over all cores
+    template<typename Field>
+    BrickMap(const Field& field, const vec3& lo, const vec3& hi, float spacing);
+
+    bool contains(const vec3& p) const;
+    template<size_t N>
+    vmask<N> contains(const vecpack<N, 3>& p) const;
+
+    // the distance at points inside the box
+    float distance(const vec3& p) const;
+    template<size_t N>
+    vec<N> distance(const vecpack<N, 3>& p) const;
+
+    size_t num_bricks() const {
+        return samples.size() / brick_samples;
+    }
+
+    static constexpr size_t brick_size = 8;
+    static constexpr size_t brick_samples = brick_size * brick_size * brick_size;
+    static constexpr size_t cell_voxels = brick_size - 1;
+    // the whole numbers floats hold exactly
+    static constexpr size_t max_indices = size_t(1) << 24;
+
+    private:
+    size_t cell_index(size_t x, size_t y, size_t z) const {
+        return (z * dims[1] + y) * dims[0] + x;
+    }
+
+    vec3 cell_center(size_t x, size_t y, size_t z) const {
+        return lo + cell_size * vec3(x + 0.5f, y + 0.5f, z + 0.5f);
+    }
+
+    vec3 lo;
+    float spacing, cell_size;
+    size_t dims[3];
+
+    // per cell, the distance at its center and the offset of its brick in samples, negative without one
+    std::vector<float> cell_distance, cell_brick;
+    std::vector<float> samples;
+};
+
+template<typename Field>
+BrickMap::BrickMap(const Field& field, const vec3& lo, const vec3& hi, float spacing) : lo(lo) {
+    ThreadPool pool(std::thread::hardware_concurrency());
+
+    // maps whose indices would not be exact as floats are baked coarser
+    std::vector<size_t> baked_cells;
+    for (this->spacing = spacing;; this->spacing *= 2.0f) {
+        cell_size = this->spacing * cell_voxels;
+        for (size_t k = 0; k < 3; k++) dims[k] = std::max<size_t>(1, std::ceil((hi[k] - lo[k]) / cell_size));
+        baked_cells.clear();
+        if (dims[0] * dims[1] * dims[2] > max_indices) continue;
+
+        cell_distance.assign(dims[0] * dims[1] * dims[2], 0.0f);
+        cell_brick.assign(cell_distance.size(), -1.0f);
+
+        pool.run(dims[2], [&](size_t z) {
+            for (size_t y = 0; y < dims[1]; y++) {
+                for (size_t x = 0; x < dims[0]; x++) cell_distance[cell_index(x, y, z)] = field(cell_center(x, y, z));
+            }
+        });
+
+        // the surface may cross the cells whose center is within half a diagonal of it, the
+        // margin of a voxel keeps the bound of the other cells from stalling the march near bricks
+        const float reach = 0.5f * std::sqrt(3.0f) * cell_size + this->spacing;
+        for (size_t i = 0; i < cell_distance.size(); i++) {
+            if (std::abs(cell_distance[i]) > reach) continue;
+            cell_brick[i] = baked_cells.size() * brick_samples;
+            baked_cells.push_back(i);
+        }
+        if (baked_cells.size() * brick_samples <= max_indices) break;
+    }
+
+    if (this->spacing != spacing) {
+        std::cout << "BRICK MAP: spacing " << spacing << " needs more than 2^24 samples, baked every " << this->spacing << std::endl;
+    }
+    samples.resize(baked_cells.size() * brick_samples);
+
+    pool.run(baked_cells.size(), [&](size_t brick) {
+        const size_t cell = baked_cells[brick];
+        const size_t cx = cell % dims[0], cy = cell / dims[0] % dims[1], cz = cell / (dims[0] * dims[1]);
+        const vec3 corner = lo + cell_size * vec3(cx, cy, cz);
+
+        float* out = &samples[brick * brick_samples];
+        for (size_t z = 0; z < brick_size; z++) {
+            for (size_t y = 0; y < brick_size; y++) {
+                for (size_t x = 0; x < brick_size; x++) *out++ = field(corner + this->spacing * vec3(x, y, z));
+            }
+        }
+    });
+}
+
+bool BrickMap::contains(const vec3& p) const {
+    for (size_t k = 0; k < 3; k++) {
+        if (p[k] < lo[k] || p[k] >= lo[k] + dims[k] * cell_size) return false;
+    }
+    return true;
+}
+
+template<size_t N>
+vmask<N> BrickMap::contains(const vecpack<N, 3>& p) const {
+    vmask<N> res(true);
+    for (size_t k = 0; k < 3; k++) res = res & (p[k] >= lo[k]) & (p[k] < vec<N>(lo[k] + dims[k] * cell_size));
+    return res;
+}
+
+float BrickMap::distance(const vec3& p) const {
+    size_t c[3], v[3];
+    float f[3];
+    for (size_t k = 0; k < 3; k++) {
+        const float g = (p[k] - lo[k]) * (1.0f / spacing);
+        c[k] = std::min<size_t>(g * (1.0f / cell_voxels), dims[k] - 1);
+        const float local = g - c[k] * cell_voxels;
+        v[k] = std::min<size_t>(local, cell_voxels - 1);
+        f[k] = local - v[k];
+    }
+
+    const size_t cell = cell_index(c[0], c[1], c[2]);
+    if (cell_brick[cell] < 0.0f) {
+        const float d = cell_distance[cell], r = len(p - cell_center(c[0], c[1], c[2]));
+        return d >= 0.0f ? d - r : d + r;
+    }
+
+    const float* s = &samples[size_t(cell_brick[cell]) + (v[2] * brick_size + v[1]) * brick_size + v[0]];
+    auto lerp = [](float a, float b, float t) { return a + t * (b - a); };
+    const size_t dy = brick_size, dz = brick_size * brick_size;
+    const float y0 = lerp(lerp(s[0], s[1], f[0]), lerp(s[dy], s[dy + 1], f[0]), f[1]);
+    const float y1 = lerp(lerp(s[dz], s[dz + 1], f[0]), lerp(s[dz + dy], s[dz + dy + 1], f[0]), f[1]);
+    return lerp(y0, y1, f[2]);
+}
+
+template<size_t N>
+vec<N> BrickMap::distance(const vecpack<N, 3>& p) const {
+    // cell and voxel indices are accumulated into offsets, x varying fastest
+    vec<N> cell(0.0f), voxel(0.0f), r2(0.0f), f[3];
+    float cell_stride = 1.0f, voxel_stride = 1.0f;
+    for (size_t k = 0; k < 3; k++) {
+        const vec<N> g = (p[k] - lo[k]) * (1.0f / spacing);
+        const vec<N> c = clamp(floor(g * (1.0f / cell_voxels)), 0.0f, dims[k] - 1.0f);
+        const vec<N> local = g - c * float(cell_voxels);
+        const vec<N> v = clamp(floor(local), 0.0f, cell_voxels - 1.0f);
+        f[k] = local - v;
+
+        cell = mul_add(c, vec<N>(cell_stride), cell);
+        voxel = mul_add(v, vec<N>(voxel_stride), voxel);
+        const vec<N> offset = p[k] - mul_add(c + 0.5f, vec<N>(cell_size), vec<N>(lo[k]));
+        r2 = mul_add(offset, offset, r2);
+
+        cell_stride *= dims[k];
+        voxel_stride *= brick_size;
+    }
+
+    const vec<N> brick = gather(cell_brick.data(), cell);
+    const vec<N> center = gather(cell_distance.data(), cell);
+    const vec<N> r = sqrt(r2);
+    const vec<N> bound = select(center >= 0.0f, center - r, center + r);
+
+    const vmask<N> baked = brick >= 0.0f;
+    if (none(baked)) return bound;
+
+    // the lanes without a brick read the first sample, and keep their bound
+    const vec<N> base = select(baked, brick + voxel, vec<N>(0.0f));
+    const float* s = samples.data();
+    auto lerp = [](const vec<N>& a, const vec<N>& b, const vec<N>& t) { return mul_add(t, b - a, a); };
+    auto edge = [&](float offset) {
+        return lerp(gather(s, base + offset), gather(s, base + (offset + 1.0f)), f[0]);
+    };
+    const float dy = brick_size, dz = brick_size * brick_size;
+    const vec<N> y0 = lerp(edge(0.0f), edge(dy), f[1]);
+    const vec<N> y1 = lerp(edge(dz), edge(dz + dy), f[1]);
+    return select(baked, lerp(y0, y1, f[2]), bound);
+}
+
+// a scene node, see sdf.hpp, sampling a static child from a brick map over [lo, hi]. Points
+// outside of the box, the normals, which are only evaluated once per ray, and the bounds over
+// boxes use the child.
+template<typename Child>
+struct Baked {
+    Child child;
+    BrickMap map;
+
+    auto operator()(const float t, const vec3& p) const {
+        return map.contains(p) ? map.distance(p) : child(t, p);
+    }
+
+    template<size_t N>
+    vec<N> operator()(const float t, const vecpack<N, 3>& p) const {
+        const vmask<N> inside = map.contains(p);
+        if (all(inside)) return map.distance(p);
+        if (none(inside)) return child(t, p);
+        return select(inside, map.distance(p), child(t, p));
+    }
+
+    template<size_t N>
+    auto operator()(const float t, const dualpack<N, 3>& p) const {
+        return child(t, p);
+    }
+
+    interval operator()(const float t, const intervalpack<3>& p) const {
+        return child(t, p);
+    }
+};
+
+template<typename Child>
+Baked<Child> bake(const vec3& lo, const vec3& hi, float spacing, const Child& child) {
+    return { child, BrickMap([&child](const vec3& p) { return child(0.0f, p); }, lo, hi, spacing) };
+}
+
+#endif
@@ -0,0 +1,221 @@
+#ifndef BVH_HPP
+#define BVH_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "linalg/vec.hpp"
+#include "linalg/vecpack.hpp"
+#include "linalg/dual.hpp"
+#include "linalg/interval.hpp"
+#include "distances.hpp"
+
+struct Primitive {
+    enum class Kind { sphere, box };
+
+    Kind kind;
+    vec3 center;
+    // the radius of a sphere in size[0], the half extents of a box
+    vec3 size;
+
+    static Primitive sphere(const vec3& center, float r) {
+        return { Kind::sphere, center, vec3(r) };
+    }
+
+    static Primitive box(const vec3& center, const vec3& half_extents) {
+        return { Kind::box, center, half_extents };
+    }
+
+    // radius of a sphere around center containing the primitive
+    float bounding_radius() const {
+        return kind == Kind::sphere ? size[0] : len(size);
+    }
+
+    template<typename point>
+    auto distance(const point& p) const {
+        const point q = p - center;
+        return kind == Kind::sphere ? dist_sphere(size[0], q) : dist_box(size, q);
+    }
+};
+
+// whether no lane of bound is below d
+bool none_below(float bound, float d) { return bound >= d; }
+
+template<size_t N>
+bool none_below(const vec<N>& bound, const vec<N>& d) { return all(bound >= d); }
+
+// sum of the lanes, to compare bounds across a pack
+float lane_sum(float v) { return v; }
+
+template<size_t N>
+float lane_sum(const vec<N>& v) { return sum(v); }
+
+// Bounding volume hierarchy over the primitives of a scene. Every node bounds its primitives
+// with a sphere, the distance to which is a lower bound of the distance to any of them: the
+// subtrees whose bound is farther than the closest primitive found so far are skipped, for a
+// pack of points once they are for all of its lanes. Nearer children are visited first so that
+// the closest primitive is found early and prunes most of the others.
+class Bvh {
+    public:
+    Bvh(const std::vector<Primitive>& primitives) : primitives(primitives) {
+        if (this->primitives.empty()) return;
+        nodes.reserve(2 * this->primitives.size());
+        nodes.push_back(Node());
+        build(0, 0, this->primitives.size(), 0);
+    }
+
+    // the distance to the closest primitive, max_distance without any
+    template<typename point>
+    auto distance(const point& p) const;
+
+    // bounds of the distance over a box
+    interval distance(const intervalpack<3>& p) const;
+
+    size_t size() const {
+        return primitives.size();
+    }
+
+    static constexpr size_t max_leaf_size = 4;
+    static constexpr float max_distance = 1e10f;
+    // The traversals hold at most one node per level plus one, the median splits keep the depth
+    // within log2 of the number of primitives, i.e. below 32 for node indices in 32 bits.
+    static constexpr size_t max_depth = 64;
+
+    private:
+    struct Node {
+        vec3 center;
+        float radius;
+        // leaves hold the primitives [first, first + count), the children of the others are first and first + 1
+        uint32_t first, count;
+    };
+
+    void build(size_t index, size_t begin, size_t end, size_t depth);
+
+    template<typename point>
+    auto bound(const Node& node, const point& p) const {
+        return len(p - node.center) - node.radius;
+    }
+
+    std::vector<Primitive> primitives;
+    std::vector<Node> nodes;
+};
+
+void Bvh::build(size_t index, size_t begin, size_t end, size_t depth) {
+    assert(depth < max_depth);
+    vec3 lo(std::numeric_limits<float>::max()), hi(-std::numeric_limits<float>::max());
+    for (size_t i = begin; i < end; i++) {
+        const vec3& c = primitives[i].center;
+        const float r = primitives[i].bounding_radius();
+        for (size_t k = 0; k < 3; k++) {
+            lo[k] = std::min(lo[k], c[k] - r);
+            hi[k] = std::max(hi[k], c[k] + r);
+        }
+    }
+
+    Node node;
+    node.center = 0.5f * (lo + hi);
+    node.radius = 0.0f;
+    for (size_t i = begin; i < end; i++) {
+        node.radius = std::max(node.radius, len(primitives[i].center - node.center) + primitives[i].bounding_radius());
+    }
+
+    if (end - begin <= max_leaf_size) {
+        node.first = begin;
+        node.count = end - begin;
+        nodes[index] = node;
+        return;
+    }
+
+    // median split along the longest side of the box
+    const vec3 extent = hi - lo;
+    const size_t axis = extent[0] > extent[1] ? (extent[0] > extent[2] ? 0 : 2) : (extent[1] > extent[2] ? 1 : 2);
+    const size_t middle = (begin + end) / 2;
+    std::nth_element(primitives.begin() + begin, primitives.begin() + middle, primitives.begin() + end,
+        [axis](const Primitive& a, const Primitive& b) { return a.center[axis] < b.center[axis]; });
+
+    node.first = nodes.size();
+    node.count = 0;
+    nodes[index] = node;
+    nodes.push_back(Node());
+    nodes.push_back(Node());
+    build(node.first, begin, middle, depth + 1);
+    build(node.first + 1, middle, end, depth + 1);
+}
+
+template<typename point>
+auto Bvh::distance(const point& p) const {
+    using std::min;
+    const auto& x = value_of(p);
+
+    decltype(primitives[0].distance(p)) d(max_distance);
+    if (nodes.empty()) return d;
+
+    uint32_t stack[max_depth];
+    size_t top = 0;
+    stack[top++] = 0;
+
+    while (top > 0) {
+        const Node& node = nodes[stack[--top]];
+        if (none_below(bound(node, x), value_of(d))) continue;
+
+        if (node.count > 0) {
+            for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                d = min(d, primitives[i].distance(p));
+            }
+            continue;
+        }
+
+        // the nearer child goes on top
+        const bool left_nearer = lane_sum(bound(nodes[node.first], x)) <= lane_sum(bound(nodes[node.first + 1], x));
+        stack[top++] = left_nearer ? node.first + 1 : node.first;
+        stack[top++] = left_nearer ? node.first : node.first + 1;
+    }
+
+    return d;
+}
+
+// the subtrees whose bound is above the upper bound of the closest primitive found so far are
+// skipped, the lower bound is the least of the reached primitives and subtrees
+interval Bvh::distance(const intervalpack<3>& p) const {
+    interval d(max_distance);
+    if (nodes.empty()) return d;
+
+    uint32_t stack[max_depth];
+    size_t top = 0;
+    stack[top++] = 0;
+
+    while (top > 0) {
+        const Node& node = nodes[stack[--top]];
+        if (bound(node, p).lo >= d.hi) continue;
+
+        if (node.count > 0) {
+            for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                d = min(d, primitives[i].distance(p));
+            }
+            continue;
+        }
+
+        const bool left_nearer = bound(nodes[node.first], p).lo <= bound(nodes[node.first + 1], p).lo;
+        stack[top++] = left_nearer ? node.first + 1 : node.first;
+        stack[top++] = left_nearer ? node.first : node.first + 1;
+    }
+
+    return d;
+}
+
+// a scene node, see sdf.hpp, evaluating the hierarchy
+struct Group {
+    Bvh bvh;
+
+    template<typename point>
+    auto operator()(const float t, const point& p) const {
+        return bvh.distance(p);
+    }
+};
+
+Group group(const std::vector<Primitive>& primitives) { return { Bvh(primitives) }; }
+
+#endif
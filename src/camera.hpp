@@ -22,25 +22,41 @@ class Camera {
 
     vec3 get_ray_dir(const vec2& pixel) const {
         vec2 xy = pixel - screen_dim * 0.5f;
-
-        float cot_half_fov = tan((90.0 - fov * 0.5) * M_PI / 180.0f);
-        float z = screen_dim[1] * 0.5 * cot_half_fov;
+        float z = focal_length();
         
         vec3 dir = normalize(vec3(xy, -z));
         return rotation_matrix * dir;
     }
 
-    vecpack<8, 3> get_ray_dir_simd(const vecpack<8, 2>& pixels) const {
-        vecpack<8, 2> xy = pixels - screen_dim * 0.5f;
-
-        float cot_half_fov = tan((90.0 - fov * 0.5) * M_PI / 180.0f);
-        float z = screen_dim[1] * 0.5 * cot_half_fov;
+    template<size_t N>
+    vecpack<N, 3> get_ray_dir_simd(const vecpack<N, 2>& pixels) const {
+        vecpack<N, 2> xy = pixels - screen_dim * 0.5f;
+        float z = focal_length();
         
-        vecpack<8, 3> dir = normalize(vecpack<8, 3>({ xy[0], xy[1], vec<8>(-z) }));
+        vecpack<N, 3> dir = normalize(vecpack<N, 3>({ xy[0], xy[1], vec<N>(-z) }));
 
         return rotation_matrix * dir;
     }
 
+    // distance from the eye to the image plane, in pixels
+    float focal_length() const {
+        float cot_half_fov = tan((90.0 - fov * 0.5) * M_PI / 180.0f);
+        return screen_dim[1] * 0.5 * cot_half_fov;
+    }
+
+    const mat3& rotation() const {
+        return rotation_matrix;
+    }
+
+    // size of the image the rays are cast through, in pixels
+    void set_screen_dim(const vec2& dim) {
+        screen_dim = dim;
+    }
+
+    const vec2& get_screen_dim() const {
+        return screen_dim;
+    }
+
     vec3 position;
     float xz_rotation;
 
@@ -0,0 +1,204 @@
+#ifndef DEPTH_CACHE_HPP
+#define DEPTH_CACHE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "camera.hpp"
+#include "thread_pool.hpp"
+#include "linalg/mat3.hpp"
+#include "linalg/vec.hpp"
+
+// Keeps the hit distances of the last frame and reprojects them through the new camera
+// to give every ray of the next frame a start distance. Pixels are indexed in camera
+// coordinates, i.e. as given to Shader::render_pixel_simd.
+//
+// The start distances are a guess rather than a bound: they are pulled in by a safety
+// margin, and the shader falls back to a full march when a ray starts inside a surface.
+// Surfaces in front of the guess, such as an object moving over the background, are stepped
+// over unnoticed. Two things limit this. A pixel starts from the nearest reprojected hit
+// around it, and from the near plane next to disoccluded pixels, which no hit or miss lands
+// on, so that depth edges are marched from their near side. And every frame a different one
+// of refresh_period rows marches from the near plane, so that a wrong start lasts at most
+// refresh_period frames rather than being recorded again as long as the view stays still.
+// This only makes the errors rarer and shorter lived, the cache is therefore left out of
+// the default build, see REPROJECT in app.hpp.
+//
+// Frames are sized by their camera's screen dimensions, which may change from one frame
+// to the next as long as they stay within the maximum size the cache was created with.
+class DepthCache {
+    public:
+    DepthCache(size_t max_width, size_t max_height, const Camera& camera) :
+        current(max_width * max_height, -1.0f),
+        previous(max_width * max_height, -1.0f),
+        start(max_width * max_height, near_plane),
+        splats(max_width * max_height),
+        nearest(max_width * max_height),
+        current_camera(camera), previous_camera(camera),
+        reprojection_rotation(rotationY(0)) {
+        for (auto& s : splats) s.store(std::numeric_limits<float>::infinity());
+    }
+
+    // to be called before painting a frame, once the previous one is complete.
+    // The reprojection is spread over the pool, or runs on the calling thread without one.
+    void begin_frame(const Camera& camera, ThreadPool* pool = nullptr);
+
+    // start distance of the rays through the simd_width pixels (x + i * stride, y)
+    vec<simd_width> start_distance(size_t x, size_t y, size_t stride = 1) const;
+
+    // hit distance of the simd_width pixels (x + i * stride, y), negative on a miss. Each hit
+    // also covers the stride - 1 pixels following it, as coarse frames fill blocks.
+    void record(size_t x, size_t y, const vec<simd_width>& hit_time, size_t stride = 1);
+
+    static constexpr float near_plane = 1.0f;
+    static constexpr float safety_margin = 0.9f;
+    static constexpr size_t refresh_period = 16;
+
+    private:
+    void splat_rows(size_t min_row, size_t max_row);
+    void collect_rows(size_t min_row, size_t max_row);
+    void resolve_rows(size_t min_row, size_t max_row);
+
+    static size_t width(const Camera& camera) { return camera.get_screen_dim()[0]; }
+    static size_t height(const Camera& camera) { return camera.get_screen_dim()[1]; }
+
+    static constexpr size_t rows_per_job = 8;
+    // the splat of a miss, which the pixels around ignore rather than take for a disocclusion
+    static constexpr float sky = std::numeric_limits<float>::max();
+
+    std::vector<float> current, previous, start;
+    // nearest reprojected distance per pixel, written concurrently by the splatting jobs
+    // and reset to infinity once resolved into start
+    std::vector<std::atomic<float>> splats;
+    // the splats of the frame, read around every pixel once collected
+    std::vector<float> nearest;
+    // frames begun, which picks the rows refreshed
+    size_t frame = 0;
+
+    Camera current_camera, previous_camera;
+    // maps points in the previous camera's frame to the current camera's frame
+    mat3 reprojection_rotation;
+    vec3 reprojection_offset;
+};
+
+void DepthCache::begin_frame(const Camera& camera, ThreadPool* pool) {
+    std::swap(current, previous);
+    frame++;
+    previous_camera = current_camera;
+    current_camera = camera;
+
+    const mat3 to_current = transpose(current_camera.rotation());
+    reprojection_rotation = to_current * previous_camera.rotation();
+    reprojection_offset = to_current * (previous_camera.position - current_camera.position);
+
+    // the previous hits are splatted row by row of the previous frame, then collected and
+    // resolved row by row of the current one, the resolution reading the rows around
+    const size_t previous_height = height(previous_camera);
+    const size_t current_height = height(current_camera);
+
+    if (pool) {
+        pool->run((previous_height + rows_per_job - 1) / rows_per_job, [this, previous_height](size_t job) {
+            splat_rows(job * rows_per_job, std::min(previous_height, (job + 1) * rows_per_job));
+        });
+        pool->run((current_height + rows_per_job - 1) / rows_per_job, [this, current_height](size_t job) {
+            collect_rows(job * rows_per_job, std::min(current_height, (job + 1) * rows_per_job));
+        });
+        pool->run((current_height + rows_per_job - 1) / rows_per_job, [this, current_height](size_t job) {
+            resolve_rows(job * rows_per_job, std::min(current_height, (job + 1) * rows_per_job));
+        });
+    } else {
+        splat_rows(0, previous_height);
+        collect_rows(0, current_height);
+        resolve_rows(0, current_height);
+    }
+}
+
+inline vec<simd_width> DepthCache::start_distance(size_t x, size_t y, size_t stride) const {
+    const size_t screen_width = width(current_camera);
+    std::array<float, simd_width> res;
+    for (size_t i = 0; i < simd_width; i++) res[i] = start[y * screen_width + x + i * stride];
+    return res;
+}
+
+inline void DepthCache::record(size_t x, size_t y, const vec<simd_width>& hit_time, size_t stride) {
+    const size_t screen_width = width(current_camera);
+    std::array<float, simd_width> res = hit_time;
+    for (size_t i = 0; i < simd_width; i++) {
+        std::fill_n(current.begin() + y * screen_width + x + i * stride, stride, res[i]);
+    }
+}
+
+// forward splat of the previous hits, each landing on the 4 pixels around its projection
+void DepthCache::splat_rows(size_t min_row, size_t max_row) {
+    const float previous_focal = previous_camera.focal_length();
+    const float current_focal = current_camera.focal_length();
+    const size_t previous_width = width(previous_camera), previous_height = height(previous_camera);
+    const size_t screen_width = width(current_camera), screen_height = height(current_camera);
+
+    for (size_t y = min_row; y < max_row; y++) {
+        for (size_t x = 0; x < previous_width; x++) {
+            const float t = previous[y * previous_width + x];
+
+            // misses are seen at infinity, only the rotation moves them
+            const vec3 dir = normalize(vec3(x - 0.5f * previous_width, y - 0.5f * previous_height, -previous_focal));
+            const vec3 p = t < 0 ? reprojection_rotation * dir : reprojection_rotation * (t * dir) + reprojection_offset;
+            if (p[2] >= 0) continue;
+
+            const float scale = current_focal / -p[2];
+            const float qx = std::floor(p[0] * scale + 0.5f * screen_width);
+            const float qy = std::floor(p[1] * scale + 0.5f * screen_height);
+            if (qx < -1 || qy < -1 || qx >= screen_width || qy >= screen_height) continue;
+
+            const float d = t < 0 ? sky : len(p);
+            for (int dy = 0; dy < 2; dy++) {
+                for (int dx = 0; dx < 2; dx++) {
+                    const int sx = qx + dx, sy = qy + dy;
+                    if (sx < 0 || sy < 0 || sx >= (int)screen_width || sy >= (int)screen_height) continue;
+
+                    std::atomic<float>& s = splats[sy * screen_width + sx];
+                    float nearest = s.load(std::memory_order_relaxed);
+                    while (d < nearest && !s.compare_exchange_weak(nearest, d, std::memory_order_relaxed)) {}
+                }
+            }
+        }
+    }
+}
+
+void DepthCache::collect_rows(size_t min_row, size_t max_row) {
+    const size_t screen_width = width(current_camera);
+    for (size_t i = min_row * screen_width; i < max_row * screen_width; i++) {
+        nearest[i] = splats[i].exchange(std::numeric_limits<float>::infinity(), std::memory_order_relaxed);
+    }
+}
+
+void DepthCache::resolve_rows(size_t min_row, size_t max_row) {
+    const size_t screen_width = width(current_camera), screen_height = height(current_camera);
+    for (size_t y = min_row; y < max_row; y++) {
+        if ((y + frame) % refresh_period == 0) {
+            std::fill_n(start.begin() + y * screen_width, screen_width, near_plane);
+            continue;
+        }
+
+        const size_t first_row = y - std::min<size_t>(y, 1), last_row = std::min(y + 1, screen_height - 1);
+        for (size_t x = 0; x < screen_width; x++) {
+            const size_t first_column = x - std::min<size_t>(x, 1), last_column = std::min(x + 1, screen_width - 1);
+
+            float d = std::numeric_limits<float>::infinity();
+            bool disoccluded = false;
+            for (size_t sy = first_row; sy <= last_row; sy++) {
+                for (size_t sx = first_column; sx <= last_column; sx++) {
+                    const float s = nearest[sy * screen_width + sx];
+                    disoccluded = disoccluded || std::isinf(s);
+                    if (s != sky) d = std::min(d, s);
+                }
+            }
+            start[y * screen_width + x] = disoccluded || std::isinf(d) ? near_plane : std::max(near_plane, safety_margin * d);
+        }
+    }
+}
+
+#endif
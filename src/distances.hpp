@@ -5,12 +5,23 @@
 
 #include "linalg/vec.hpp"
 #include "linalg/vecpack.hpp"
+#include "linalg/dual.hpp"
+#include "linalg/interval.hpp"
 
 template<size_t N_vecs>
 vec<N_vecs> dist_sphere(float r, const vecpack<N_vecs, 3>& p) {
     return len(p) - r;
 }
 
+template<size_t N_vecs>
+dual<N_vecs> dist_sphere(float r, const dualpack<N_vecs, 3>& p) {
+    return len(p) - r;
+}
+
+interval dist_sphere(float r, const intervalpack<3>& p) {
+    return len(p) - r;
+}
+
 template<size_t N>
 float dist_sphere(float r, const vec<N>& p) {
     return len(p) - r;
@@ -25,6 +36,15 @@ vec<N_vecs> dist_plane(const vec3& n, float h, const vecpack<N_vecs, 3>& p) {
   return dot(p,n) + h;
 }
 
+template<size_t N_vecs>
+dual<N_vecs> dist_plane(const vec3& n, float h, const dualpack<N_vecs, 3>& p) {
+  return dot(p,n) + h;
+}
+
+interval dist_plane(const vec3& n, float h, const intervalpack<3>& p) {
+  return dot(p,n) + h;
+}
+
 float dist_box(const vec3& b, const vec3& p) {
   vec3 q = abs(p) - b;
   return len(max(q,0.0f)) + std::min(std::max(q[0],std::max(q[1],q[2])),0.0f);
@@ -37,6 +57,19 @@ vec<N_vecs> dist_box(const vec3& b, const vecpack<N_vecs, 3>& p) {
   return len(max(q,0.0f)) + min(maxdim,0.0f);
 }
 
+template<size_t N_vecs>
+dual<N_vecs> dist_box(const vec3& b, const dualpack<N_vecs, 3>& p) {
+  dualpack<N_vecs, 3> q = abs(p) - b;
+  dual<N_vecs> maxdim = max(q[0],max(q[1],q[2]));
+  return len(max(q,0.0f)) + min(maxdim,0.0f);
+}
+
+interval dist_box(const vec3& b, const intervalpack<3>& p) {
+  intervalpack<3> q = abs(p) - b;
+  interval maxdim = max(q[0],max(q[1],q[2]));
+  return len(max(q,0.0f)) + min(maxdim,0.0f);
+}
+
 float dist_torus(const vec2& t, const vec3& p) {
   vec2 q = vec2(len(vec2(p[0], p[2]))-t[0],p[1]);
   return len(q)-t[1];
@@ -0,0 +1,6 @@
+// the program running on 8 lanes of AVX2 and FMA, built with -mavx2 -mfma (see the Makefile)
+#include "system_headers.hpp"
+
+namespace avx2 {
+#include "../app.hpp"
+}
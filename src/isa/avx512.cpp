@@ -0,0 +1,6 @@
+// the program running on 16 lanes of AVX-512F, built with -mavx512f -mavx2 -mfma (see the Makefile)
+#include "system_headers.hpp"
+
+namespace avx512 {
+#include "../app.hpp"
+}
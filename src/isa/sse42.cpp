@@ -0,0 +1,6 @@
+// the program running on 4 lanes of SSE4.2, built with -msse4.2 (see the Makefile)
+#include "system_headers.hpp"
+
+namespace sse42 {
+#include "../app.hpp"
+}
@@ -0,0 +1,38 @@
+#ifndef SYSTEM_HEADERS_HPP
+#define SYSTEM_HEADERS_HPP
+
+// Every system header included by the program. They are included here, outside of the
+// instruction set namespaces, so that their include guards skip them within app.hpp.
+
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// see linalg/vec.hpp
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#pragma GCC diagnostic pop
+
+#endif
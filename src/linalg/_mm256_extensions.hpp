@@ -143,4 +143,76 @@ static inline __m256 _mm256_pow_ps(__m256 x, __m256 y) {
    return _mm256_exp2_ps(_mm256_mul_ps(_mm256_log2_ps(x), y));
 }
 
-#endif
\ No newline at end of file
+// sin and cos share their range reduction, x = q * pi/2 + r with |r| <= pi/4. pi/2 is split in
+// three parts whose products with q are exact as long as |x| <= 8192, the polynomials are those
+// of Cephes' sinf and cosf on [-pi/4, pi/4]. Measured against double precision for |x| <= 8192:
+// at most 2 ulp where the result is above 0.01 in magnitude, an absolute error below 1e-9 elsewhere.
+void _mm256_sincos_ps(__m256 x, __m256* s, __m256* c) {
+    const __m256 q = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(0.636619772f)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+
+    __m256 r = _mm256_sub_ps(x, _mm256_mul_ps(q, _mm256_set1_ps(1.5703125f)));
+    r = _mm256_sub_ps(r, _mm256_mul_ps(q, _mm256_set1_ps(4.837512969970703125e-4f)));
+    r = _mm256_sub_ps(r, _mm256_mul_ps(q, _mm256_set1_ps(7.54978995489188216e-8f)));
+    const __m256 z = _mm256_mul_ps(r, r);
+
+    /* sin(r) ~= r + r^3 * p(r^2), cos(r) ~= 1 - r^2 / 2 + r^4 * p(r^2) */
+    __m256 sr = POLY2(z, -1.6666654611e-1f, 8.3321608736e-3f, -1.9515295891e-4f);
+    sr = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(sr, z), r), r);
+    __m256 cr = POLY2(z, 4.166664568298827e-2f, -1.388731625493765e-3f, 2.443315711809948e-5f);
+    cr = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(cr, z), z), _mm256_sub_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(z, _mm256_set1_ps(0.5f))));
+
+    /* odd quadrants swap sin and cos, sin is negated in quadrants 2 and 3, cos in quadrants 1 and 2 */
+    const __m256i qi = _mm256_cvtps_epi32(q), one = _mm256_set1_epi32(1), two = _mm256_set1_epi32(2);
+    const __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(qi, one), one));
+    const __m256 sin_sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(qi, two), 30));
+    const __m256 cos_sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(qi, one), two), 30));
+
+    *s = _mm256_xor_ps(_mm256_blendv_ps(sr, cr, swap), sin_sign);
+    *c = _mm256_xor_ps(_mm256_blendv_ps(cr, sr, swap), cos_sign);
+}
+
+__m256 _mm256_sin_ps(__m256 x) {
+    __m256 s, c;
+    _mm256_sincos_ps(x, &s, &c);
+    return s;
+}
+
+__m256 _mm256_cos_ps(__m256 x) {
+    __m256 s, c;
+    _mm256_sincos_ps(x, &s, &c);
+    return c;
+}
+
+// The ratio of the smaller to the larger of |x| and |y| is in [0, 1], above tan(pi/8) it is brought
+// below it with atan(a) = pi/4 + atan((a - 1) / (a + 1)), then approximated by the polynomial of
+// Cephes' atanf. The octant is restored from the signs and the order of |x| and |y|.
+// Measured against double precision: at most 4 ulp. atan2(0, 0) is 0.
+__m256 _mm256_atan2_ps(__m256 y, __m256 x) {
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    const __m256 ax = _mm256_andnot_ps(sign, x), ay = _mm256_andnot_ps(sign, y);
+    const __m256 hi = _mm256_max_ps(ax, ay), lo = _mm256_min_ps(ax, ay);
+    __m256 a = _mm256_div_ps(lo, _mm256_max_ps(hi, _mm256_set1_ps(1e-37f)));
+
+    const __m256 reduced = _mm256_cmp_ps(a, _mm256_set1_ps(0.414213562f), _CMP_GT_OQ);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    a = _mm256_blendv_ps(a, _mm256_div_ps(_mm256_sub_ps(a, one), _mm256_add_ps(a, one)), reduced);
+
+    const __m256 z = _mm256_mul_ps(a, a);
+    __m256 r = POLY3(z, -3.33329491539e-1f, 1.99777106478e-1f, -1.38776856032e-1f, 8.05374449538e-2f);
+    r = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(r, z), a), a);
+    r = _mm256_add_ps(r, _mm256_and_ps(reduced, _mm256_set1_ps(0.785398163f)));
+
+    r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(1.570796327f), r), _mm256_cmp_ps(ay, ax, _CMP_GT_OQ));
+    r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(3.141592654f), r), _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ));
+    return _mm256_xor_ps(r, _mm256_and_ps(y, sign));
+}
+
+// the 12 bit estimate of the instruction refined by a Newton step, y' = y * (1.5 - 0.5 * x * y^2).
+// Measured against double precision: at most 4 ulp for normal x.
+__m256 _mm256_rsqrt_nr_ps(__m256 x) {
+    const __m256 y = _mm256_rsqrt_ps(x);
+    const __m256 hxy2 = _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(x, _mm256_set1_ps(0.5f)), y), y);
+    return _mm256_mul_ps(y, _mm256_sub_ps(_mm256_set1_ps(1.5f), hxy2));
+}
+
+#endif
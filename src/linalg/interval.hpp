@@ -0,0 +1,145 @@
+#ifndef INTERVAL_HPP
+#define INTERVAL_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+#include "vec.hpp"
+
+// Interval arithmetic. An interval holds every value an expression may take for operands
+// ranging over their intervals, so that a distance field evaluated on the intervalpack of a
+// box bounds the distances over the whole box: a positive lower bound proves it empty.
+// The bounds are computed in float arithmetic, without outward rounding, and the gaps
+// between sides of a non-monotonic function (min, max, abs) are not tracked.
+struct interval {
+    float lo, hi;
+
+    interval() : lo(0.0f), hi(0.0f) {}
+    interval(float x) : lo(x), hi(x) {}
+    interval(float lo, float hi) : lo(lo), hi(hi) {}
+
+    static interval everything() {
+        return interval(-std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity());
+    }
+};
+
+template<size_t M>
+struct intervalpack {
+    std::array<interval, M> data;
+
+    interval& operator[](int i) {
+        return this->data[i];
+    }
+
+    const interval& operator[](int i) const {
+        return this->data[i];
+    }
+};
+
+interval operator-(const interval& v) {
+    return interval(-v.hi, -v.lo);
+}
+
+interval operator+(const interval& lhs, const interval& rhs) {
+    return interval(lhs.lo + rhs.lo, lhs.hi + rhs.hi);
+}
+
+interval operator-(const interval& lhs, const interval& rhs) {
+    return interval(lhs.lo - rhs.hi, lhs.hi - rhs.lo);
+}
+
+interval operator*(const interval& lhs, const interval& rhs) {
+    const float a = lhs.lo * rhs.lo, b = lhs.lo * rhs.hi, c = lhs.hi * rhs.lo, d = lhs.hi * rhs.hi;
+    return interval(std::min({ a, b, c, d }), std::max({ a, b, c, d }));
+}
+
+interval operator*(const interval& lhs, float rhs) {
+    return rhs >= 0.0f ? interval(lhs.lo * rhs, lhs.hi * rhs) : interval(lhs.hi * rhs, lhs.lo * rhs);
+}
+
+interval operator*(float lhs, const interval& rhs) { return rhs * lhs; }
+
+interval operator+(const interval& lhs, float rhs) { return interval(lhs.lo + rhs, lhs.hi + rhs); }
+
+interval operator+(float lhs, const interval& rhs) { return rhs + lhs; }
+
+interval operator-(const interval& lhs, float rhs) { return interval(lhs.lo - rhs, lhs.hi - rhs); }
+
+interval operator-(float lhs, const interval& rhs) { return interval(lhs - rhs.hi, lhs - rhs.lo); }
+
+interval min(const interval& lhs, const interval& rhs) {
+    return interval(std::min(lhs.lo, rhs.lo), std::min(lhs.hi, rhs.hi));
+}
+
+interval max(const interval& lhs, const interval& rhs) {
+    return interval(std::max(lhs.lo, rhs.lo), std::max(lhs.hi, rhs.hi));
+}
+
+interval clamp(const interval& v, float lo, float hi) {
+    return interval(std::clamp(v.lo, lo, hi), std::clamp(v.hi, lo, hi));
+}
+
+interval abs(const interval& v) {
+    if (v.lo >= 0.0f) return v;
+    if (v.hi <= 0.0f) return -v;
+    return interval(0.0f, std::max(-v.lo, v.hi));
+}
+
+interval sqr(const interval& v) {
+    const interval a = abs(v);
+    return interval(a.lo * a.lo, a.hi * a.hi);
+}
+
+interval sqrt(const interval& v) {
+    return interval(std::sqrt(std::max(v.lo, 0.0f)), std::sqrt(std::max(v.hi, 0.0f)));
+}
+
+interval floor(const interval& v) {
+    return interval(std::floor(v.lo), std::floor(v.hi));
+}
+
+template<size_t M>
+intervalpack<M> operator+(const intervalpack<M>& lhs, const vec<M>& rhs) {
+    intervalpack<M> res;
+    for (size_t i = 0; i < M; i++) res[i] = lhs[i] + rhs[i];
+    return res;
+}
+
+template<size_t M>
+intervalpack<M> operator-(const intervalpack<M>& lhs, const vec<M>& rhs) {
+    intervalpack<M> res;
+    for (size_t i = 0; i < M; i++) res[i] = lhs[i] - rhs[i];
+    return res;
+}
+
+template<size_t M>
+intervalpack<M> abs(const intervalpack<M>& v) {
+    intervalpack<M> res;
+    for (size_t i = 0; i < M; i++) res[i] = abs(v[i]);
+    return res;
+}
+
+template<size_t M>
+intervalpack<M> max(const intervalpack<M>& v, float x) {
+    intervalpack<M> res;
+    for (size_t i = 0; i < M; i++) res[i] = max(v[i], x);
+    return res;
+}
+
+template<size_t M>
+interval dot(const intervalpack<M>& lhs, const vec<M>& rhs) {
+    interval res = lhs[0] * rhs[0];
+    for (size_t i = 1; i < M; i++) res = res + lhs[i] * rhs[i];
+    return res;
+}
+
+template<size_t M>
+interval len(const intervalpack<M>& v) {
+    interval squares = sqr(v[0]);
+    for (size_t i = 1; i < M; i++) squares = squares + sqr(v[i]);
+    return sqrt(squares);
+}
+
+#endif
@@ -29,6 +29,12 @@ mat3 transpose(const mat3& m) {
             m[2], m[5], m[8]};
 }
 
+mat3 operator*(const mat3& a, const mat3& b) {
+    return {a[0]*b[0] + a[1]*b[3] + a[2]*b[6], a[0]*b[1] + a[1]*b[4] + a[2]*b[7], a[0]*b[2] + a[1]*b[5] + a[2]*b[8],
+            a[3]*b[0] + a[4]*b[3] + a[5]*b[6], a[3]*b[1] + a[4]*b[4] + a[5]*b[7], a[3]*b[2] + a[4]*b[5] + a[5]*b[8],
+            a[6]*b[0] + a[7]*b[3] + a[8]*b[6], a[6]*b[1] + a[7]*b[4] + a[8]*b[7], a[6]*b[2] + a[7]*b[5] + a[8]*b[8]};
+}
+
 vec3 operator*(const mat3& m, const vec3& v) { 
     return {m[0]*v[0] + m[1]*v[1] + m[2]*v[2],
             m[3]*v[0] + m[4]*v[1] + m[5]*v[2],
@@ -28,6 +28,9 @@ struct vec {
     const float& operator[](int i) const {
         return this->data[i];
     }
+    operator std::array<float, N>() const {
+        return this->data;
+    }
     vec<N>& operator=(float x) {
         std::fill(std::begin(this->data), std::end(this->data), x);
         return *this;
@@ -49,10 +52,288 @@ struct vec3 : vec<3> {
     vec3(const vec<2>& xy, float z) : vec<3>({xy[0], xy[1], z}) {}
 };
 
+// Lane predicates, as produced by the comparisons of vecs. Masks select between vecs
+// and are reduced to bits, bit i being set when lane i is, so that the loops checking
+// whether all lanes are done only test an integer.
+template<size_t N>
+struct vmask {
+    static_assert(N <= 32, "the lanes must fit in the bits of an unsigned int");
+    std::array<bool, N> data;
+
+    vmask(bool b = false) {
+        std::fill(std::begin(this->data), std::end(this->data), b);
+    }
+    static vmask<N> from_bits(unsigned int bits) {
+        vmask<N> res;
+        for (size_t i = 0; i < N; i++) res[i] = (bits >> i) & 1;
+        return res;
+    }
+    bool& operator[](int i) {
+        return this->data[i];
+    }
+    const bool& operator[](int i) const {
+        return this->data[i];
+    }
+};
+
 // SIMD Implementation
+// gcc 12's AVX-512 intrinsics start from an undefined register, which -Wall reports
+// as uninitialized at every call site
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
 #include <immintrin.h> 
+#pragma GCC diagnostic pop
+
+#ifdef __SSE4_1__
+#include "_mm128_extensions.hpp"
+
+// all bits of a lane set when true, so that masks blend and combine with the float bitwise operations
+template<>
+struct vmask<4> {
+    __m128 data;
+    vmask<4>(__m128 const& x) : data(x) {}
+    vmask<4>(bool b = false) {
+        data = _mm_castsi128_ps(_mm_set1_epi32(b ? -1 : 0));
+    }
+    static vmask<4> from_bits(unsigned int bits) {
+        const __m128i lanes = _mm_setr_epi32(1, 2, 4, 8);
+        return _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(bits), lanes), lanes));
+    }
+
+    operator __m128() const {
+        return data;
+    }
+};
+
+vmask<4> operator&(const vmask<4>& lhs, const vmask<4>& rhs) {
+    return _mm_and_ps(lhs, rhs);
+}
+
+vmask<4> operator|(const vmask<4>& lhs, const vmask<4>& rhs) {
+    return _mm_or_ps(lhs, rhs);
+}
+
+vmask<4> operator~(const vmask<4>& m) {
+    return _mm_xor_ps(m, vmask<4>(true));
+}
+
+unsigned int bits(const vmask<4>& m) {
+    return _mm_movemask_ps(m);
+}
+
+template<>
+struct vec<4> {
+    __m128 data;
+    vec<4>() : vec<4>(0.0f) {}
+    vec<4>(__m128 const& x) : data(x) {}
+    vec<4>(float x) {
+        data = _mm_set1_ps(x);
+    }
+    vec<4>(std::array<float, 4> x) {
+        data = _mm_loadu_ps(x.data());
+    }
+
+    operator __m128() const {
+        return data;
+    }
+
+    operator std::array<float, 4>() const {
+        std::array<float, 4> res;
+        _mm_storeu_ps(res.data(), data);
+        return res;
+    }
+
+    vec<4>& operator=(__m128 const& x) {
+        data = x;
+        return *this;
+    }
+
+    vec<4>& operator=(float x) {
+        data = _mm_set1_ps(x);
+        return *this;
+    }
+
+    vec<4>& operator=(std::array<float, 4> x) {
+        data = _mm_loadu_ps(x.data());
+        return *this;
+    }
+};
+
+vec<4> operator+(const vec<4>& lhs, const vec<4>& rhs) { 
+    return _mm_add_ps(lhs, rhs);
+}
+
+vec<4> operator-(const vec<4>& lhs, const vec<4>& rhs) { 
+    return _mm_sub_ps(lhs, rhs);
+}
+
+vec<4> operator*(const vec<4>& lhs, const vec<4>& rhs) { 
+    return _mm_mul_ps(lhs, rhs);
+}
+
+vec<4> operator/(const vec<4>& lhs, const vec<4>& rhs) { 
+    return _mm_div_ps(lhs, rhs);
+}
+
+vec<4> operator%(const vec<4>& lhs, const vec<4>& rhs) { 
+    return _mm_mod_ps(lhs, rhs);
+}
+
+vec<4> min(const vec<4>& lhs, const vec<4>& rhs) { 
+    return _mm_min_ps(lhs, rhs);
+}
+
+vec<4> min(const vec<4>& v, float x) { 
+    return _mm_min_ps(v, vec<4>(x));
+}
+
+vmask<4> operator==(const vec<4>& lhs, const vec<4>& rhs) {
+    return _mm_cmpeq_ps(lhs, rhs);
+}
+
+vmask<4> operator<(const vec<4>& lhs, const vec<4>& rhs) { 
+    return _mm_cmplt_ps(lhs, rhs);
+}
+
+vmask<4> operator<=(const vec<4>& lhs, const vec<4>& rhs) { 
+    return _mm_cmple_ps(lhs, rhs);
+}
+
+vmask<4> operator>(const vec<4>& lhs, const vec<4>& rhs) { 
+    return rhs < lhs;
+}
+
+vmask<4> operator>=(const vec<4>& lhs, const vec<4>& rhs) { 
+    return rhs <= lhs;
+}
+
+vec<4> select(const vmask<4>& m, const vec<4>& lhs, const vec<4>& rhs) {
+    return _mm_blendv_ps(rhs, lhs, m);
+}
+
+vec<4> masked_add(const vmask<4>& m, const vec<4>& lhs, const vec<4>& rhs) {
+    return _mm_add_ps(lhs, _mm_and_ps(rhs, m));
+}
+
+float dot(const vec<4>& lhs, const vec<4>& rhs) { 
+    return _mm_cvtss_f32(_mm_dp_ps(lhs, rhs, 0xf1));
+}
+
+vec<4> sqrt(const vec<4>& v) { 
+    return _mm_sqrt_ps(v);
+}
+
+vec<4> max(const vec<4>& lhs, const vec<4>& rhs) { 
+    return _mm_max_ps(lhs, rhs);
+}
+
+vec<4> max(const vec<4>& lhs, float rhs) { 
+    return _mm_max_ps(lhs, vec<4>(rhs));
+}
+
+vec<4> exp(const vec<4>& v) {
+    return _mm_exp_ps(v);
+}
+
+vec<4> abs(const vec<4>& v) {
+    return _mm_abs_ps(v);
+}
+
+vec<4> pow(const vec<4>& lhs, const vec<4>& rhs) {
+    return _mm_pow_ps(lhs, rhs);
+}
+
+vec<4> sin(const vec<4>& v) {
+    return _mm_sin_ps(v);
+}
+
+vec<4> cos(const vec<4>& v) {
+    return _mm_cos_ps(v);
+}
+
+void sincos(const vec<4>& v, vec<4>& s, vec<4>& c) {
+    _mm_sincos_ps(v, &s.data, &c.data);
+}
+
+vec<4> atan2(const vec<4>& y, const vec<4>& x) {
+    return _mm_atan2_ps(y, x);
+}
+
+vec<4> rsqrt(const vec<4>& v) {
+    return _mm_rsqrt_nr_ps(v);
+}
+
+vec<4> clamp(const vec<4>& v, float lo, float hi) {
+    return max(min(v, hi), lo);
+}
+
+vec<4> floor(const vec<4>& v) {
+    return _mm_floor_ps(v);
+}
+
+// SSE has no gather
+vec<4> gather(const float* base, const vec<4>& indices) {
+    std::array<float, 4> i = indices;
+    return _mm_setr_ps(base[int(i[0])], base[int(i[1])], base[int(i[2])], base[int(i[3])]);
+}
+
+// SSE4.2 machines need not have FMA
+vec<4> mul_add(const vec<4>& v, const vec<4>& w, const vec<4>& z) { 
+    #ifdef __FMA__
+    return _mm_fmadd_ps(v, w, z);
+    #else
+    return _mm_add_ps(_mm_mul_ps(v, w), z);
+    #endif
+}
+
+float sum(const vec<4>& v) { 
+    return dot(v, 1.0f);
+}
+
+std::ostream& operator<<(std::ostream& o, const vec<4>& v) {
+    std::array<float, 4> data = v;
+    copy(data.cbegin(), data.cend(), std::ostream_iterator<float>(o, " "));
+    return o;
+}
+#endif
+
+#if defined(__AVX2__) && defined(__FMA__)
 #include "_mm256_extensions.hpp"
 
+template<>
+struct vmask<8> {
+    __m256 data;
+    vmask<8>(__m256 const& x) : data(x) {}
+    vmask<8>(bool b = false) {
+        data = _mm256_castsi256_ps(_mm256_set1_epi32(b ? -1 : 0));
+    }
+    static vmask<8> from_bits(unsigned int bits) {
+        const __m256i lanes = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+        return _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(bits), lanes), lanes));
+    }
+
+    operator __m256() const {
+        return data;
+    }
+};
+
+vmask<8> operator&(const vmask<8>& lhs, const vmask<8>& rhs) {
+    return _mm256_and_ps(lhs, rhs);
+}
+
+vmask<8> operator|(const vmask<8>& lhs, const vmask<8>& rhs) {
+    return _mm256_or_ps(lhs, rhs);
+}
+
+vmask<8> operator~(const vmask<8>& m) {
+    return _mm256_xor_ps(m, vmask<8>(true));
+}
+
+unsigned int bits(const vmask<8>& m) {
+    return _mm256_movemask_ps(m);
+}
+
 template<>
 struct vec<8> {
     __m256 data;
@@ -123,32 +404,38 @@ vec<8> min(const vec<8>& v, float x) {
     return _mm256_min_ps(v, vec<8>(x));
 }
 
-vec<8> operator==(const vec<8>& lhs, const vec<8>& rhs) {
-    __m256 ones = _mm256_set1_ps(1.0f);
-    return _mm256_and_ps(_mm256_cmp_ps(lhs, rhs, 0), ones);
+vmask<8> operator==(const vec<8>& lhs, const vec<8>& rhs) {
+    return _mm256_cmp_ps(lhs, rhs, 0);
 }
 
-vec<8> operator<(const vec<8>& lhs, const vec<8>& rhs) { 
-    __m256 ones = _mm256_set1_ps(1.0f);
-    return _mm256_and_ps(_mm256_cmp_ps(lhs, rhs, 1), ones);
+vmask<8> operator<(const vec<8>& lhs, const vec<8>& rhs) { 
+    return _mm256_cmp_ps(lhs, rhs, 1);
 }
 
-vec<8> operator<=(const vec<8>& lhs, const vec<8>& rhs) { 
-    __m256 ones = _mm256_set1_ps(1.0f);
-    return _mm256_and_ps(_mm256_cmp_ps(lhs, rhs, 2), ones);
+vmask<8> operator<=(const vec<8>& lhs, const vec<8>& rhs) { 
+    return _mm256_cmp_ps(lhs, rhs, 2);
 }
 
-vec<8> operator>(const vec<8>& lhs, const vec<8>& rhs) { 
+vmask<8> operator>(const vec<8>& lhs, const vec<8>& rhs) { 
     return rhs < lhs;
 }
 
-vec<8> operator>=(const vec<8>& lhs, const vec<8>& rhs) { 
+vmask<8> operator>=(const vec<8>& lhs, const vec<8>& rhs) { 
     return rhs <= lhs;
 }
 
+vec<8> select(const vmask<8>& m, const vec<8>& lhs, const vec<8>& rhs) {
+    return _mm256_blendv_ps(rhs, lhs, m);
+}
+
+vec<8> masked_add(const vmask<8>& m, const vec<8>& lhs, const vec<8>& rhs) {
+    return _mm256_add_ps(lhs, _mm256_and_ps(rhs, m));
+}
+
 float dot(const vec<8>& lhs, const vec<8>& rhs) { 
+    // _mm256_dp_ps only sums within each 128 bit half
     const __m256 c = _mm256_dp_ps(lhs, rhs, 0xff);
-    return ((float*)&c)[0];
+    return _mm_cvtss_f32(_mm_add_ss(_mm256_castps256_ps128(c), _mm256_extractf128_ps(c, 1)));
 }
 
 vec<8> sqrt(const vec<8>& v) { 
@@ -175,10 +462,38 @@ vec<8> pow(const vec<8>& lhs, const vec<8>& rhs) {
     return _mm256_pow_ps(lhs, rhs);
 }
 
+vec<8> sin(const vec<8>& v) {
+    return _mm256_sin_ps(v);
+}
+
+vec<8> cos(const vec<8>& v) {
+    return _mm256_cos_ps(v);
+}
+
+void sincos(const vec<8>& v, vec<8>& s, vec<8>& c) {
+    _mm256_sincos_ps(v, &s.data, &c.data);
+}
+
+vec<8> atan2(const vec<8>& y, const vec<8>& x) {
+    return _mm256_atan2_ps(y, x);
+}
+
+vec<8> rsqrt(const vec<8>& v) {
+    return _mm256_rsqrt_nr_ps(v);
+}
+
 vec<8> clamp(const vec<8>& v, float lo, float hi) {
     return max(min(v, hi), lo);
 }
 
+vec<8> floor(const vec<8>& v) {
+    return _mm256_floor_ps(v);
+}
+
+vec<8> gather(const float* base, const vec<8>& indices) {
+    return _mm256_i32gather_ps(base, _mm256_cvttps_epi32(indices), 4);
+}
+
 vec<8> mul_add(const vec<8>& v, const vec<8>& w, const vec<8>& z) { 
     return _mm256_fmadd_ps(v, w, z);
 }
@@ -192,6 +507,226 @@ std::ostream& operator<<(std::ostream& o, const vec<8>& v) {
     copy(data.cbegin(), data.cend(), std::ostream_iterator<float>(o, " "));
     return o;
 }
+#endif
+
+#ifdef __AVX512F__
+#include "_mm512_extensions.hpp"
+
+// held in a mask register, one bit per lane
+template<>
+struct vmask<16> {
+    __mmask16 data;
+    vmask<16>(__mmask16 const& x) : data(x) {}
+    vmask<16>(bool b = false) {
+        data = b ? 0xffff : 0;
+    }
+    static vmask<16> from_bits(unsigned int bits) {
+        return __mmask16(bits);
+    }
+
+    operator __mmask16() const {
+        return data;
+    }
+};
+
+vmask<16> operator&(const vmask<16>& lhs, const vmask<16>& rhs) {
+    return _mm512_kand(lhs, rhs);
+}
+
+vmask<16> operator|(const vmask<16>& lhs, const vmask<16>& rhs) {
+    return _mm512_kor(lhs, rhs);
+}
+
+vmask<16> operator~(const vmask<16>& m) {
+    return _mm512_knot(m);
+}
+
+unsigned int bits(const vmask<16>& m) {
+    return m.data;
+}
+
+template<>
+struct vec<16> {
+    __m512 data;
+    vec<16>() : vec<16>(0.0f) {}
+    vec<16>(__m512 const& x) : data(x) {}
+    vec<16>(float x) {
+        data = _mm512_set1_ps(x);
+    }
+    vec<16>(std::array<float, 16> x) {
+        data = _mm512_loadu_ps(x.data());
+    }
+
+    operator __m512() const {
+        return data;
+    }
+
+    operator std::array<float, 16>() const {
+        std::array<float, 16> res;
+        _mm512_storeu_ps(res.data(), data);
+        return res;
+    }
+
+    vec<16>& operator=(__m512 const& x) {
+        data = x;
+        return *this;
+    }
+
+    vec<16>& operator=(float x) {
+        data = _mm512_set1_ps(x);
+        return *this;
+    }
+
+    vec<16>& operator=(std::array<float, 16> x) {
+        data = _mm512_loadu_ps(x.data());
+        return *this;
+    }
+};
+
+vec<16> operator+(const vec<16>& lhs, const vec<16>& rhs) { 
+    return _mm512_add_ps(lhs, rhs);
+}
+
+vec<16> operator-(const vec<16>& lhs, const vec<16>& rhs) { 
+    return _mm512_sub_ps(lhs, rhs);
+}
+
+vec<16> operator*(const vec<16>& lhs, const vec<16>& rhs) { 
+    return _mm512_mul_ps(lhs, rhs);
+}
+
+vec<16> operator/(const vec<16>& lhs, const vec<16>& rhs) { 
+    return _mm512_div_ps(lhs, rhs);
+}
+
+vec<16> operator%(const vec<16>& lhs, const vec<16>& rhs) { 
+    return _mm512_mod_ps(lhs, rhs);
+}
+
+vec<16> min(const vec<16>& lhs, const vec<16>& rhs) { 
+    return _mm512_min_ps(lhs, rhs);
+}
+
+vec<16> min(const vec<16>& v, float x) { 
+    return _mm512_min_ps(v, vec<16>(x));
+}
+
+vmask<16> operator==(const vec<16>& lhs, const vec<16>& rhs) {
+    return _mm512_cmp_ps_mask(lhs, rhs, _CMP_EQ_OQ);
+}
+
+vmask<16> operator<(const vec<16>& lhs, const vec<16>& rhs) { 
+    return _mm512_cmp_ps_mask(lhs, rhs, _CMP_LT_OS);
+}
+
+vmask<16> operator<=(const vec<16>& lhs, const vec<16>& rhs) { 
+    return _mm512_cmp_ps_mask(lhs, rhs, _CMP_LE_OS);
+}
+
+vmask<16> operator>(const vec<16>& lhs, const vec<16>& rhs) { 
+    return rhs < lhs;
+}
+
+vmask<16> operator>=(const vec<16>& lhs, const vec<16>& rhs) { 
+    return rhs <= lhs;
+}
+
+vec<16> select(const vmask<16>& m, const vec<16>& lhs, const vec<16>& rhs) {
+    return _mm512_mask_blend_ps(m, rhs, lhs);
+}
+
+vec<16> masked_add(const vmask<16>& m, const vec<16>& lhs, const vec<16>& rhs) {
+    return _mm512_mask_add_ps(lhs, m, lhs, rhs);
+}
+
+float dot(const vec<16>& lhs, const vec<16>& rhs) { 
+    return _mm512_reduce_add_ps(_mm512_mul_ps(lhs, rhs));
+}
+
+vec<16> sqrt(const vec<16>& v) { 
+    return _mm512_sqrt_ps(v);
+}
+
+vec<16> max(const vec<16>& lhs, const vec<16>& rhs) { 
+    return _mm512_max_ps(lhs, rhs);
+}
+
+vec<16> max(const vec<16>& lhs, float rhs) { 
+    return _mm512_max_ps(lhs, vec<16>(rhs));
+}
+
+vec<16> exp(const vec<16>& v) {
+    return _mm512_exp_ps(v);
+}
+
+vec<16> abs(const vec<16>& v) {
+    return _mm512_abs_ps(v);
+}
+
+vec<16> pow(const vec<16>& lhs, const vec<16>& rhs) {
+    return _mm512_pow_ps(lhs, rhs);
+}
+
+vec<16> sin(const vec<16>& v) {
+    return _mm512_sin_ps(v);
+}
+
+vec<16> cos(const vec<16>& v) {
+    return _mm512_cos_ps(v);
+}
+
+void sincos(const vec<16>& v, vec<16>& s, vec<16>& c) {
+    _mm512_sincos_ps(v, &s.data, &c.data);
+}
+
+vec<16> atan2(const vec<16>& y, const vec<16>& x) {
+    return _mm512_atan2_ps(y, x);
+}
+
+vec<16> rsqrt(const vec<16>& v) {
+    return _mm512_rsqrt_nr_ps(v);
+}
+
+vec<16> clamp(const vec<16>& v, float lo, float hi) {
+    return max(min(v, hi), lo);
+}
+
+vec<16> floor(const vec<16>& v) {
+    return _mm512_roundscale_ps(v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+}
+
+vec<16> gather(const float* base, const vec<16>& indices) {
+    return _mm512_i32gather_ps(_mm512_cvttps_epi32(indices), base, 4);
+}
+
+vec<16> mul_add(const vec<16>& v, const vec<16>& w, const vec<16>& z) { 
+    return _mm512_fmadd_ps(v, w, z);
+}
+
+float sum(const vec<16>& v) { 
+    return _mm512_reduce_add_ps(v);
+}
+
+std::ostream& operator<<(std::ostream& o, const vec<16>& v) {
+    std::array<float, 16> data = v;
+    copy(data.cbegin(), data.cend(), std::ostream_iterator<float>(o, " "));
+    return o;
+}
+#endif
+
+// number of lanes of the simd code paths: the widest vec the target has registers for,
+// unless fixed at build time with -DSIMD_WIDTH
+#ifndef SIMD_WIDTH
+#if defined(__AVX512F__)
+#define SIMD_WIDTH 16
+#elif defined(__AVX2__) && defined(__FMA__)
+#define SIMD_WIDTH 8
+#else
+#define SIMD_WIDTH 4
+#endif
+#endif
+
+constexpr size_t simd_width = SIMD_WIDTH;
 
 // General Implementation
 template<size_t N>
@@ -200,61 +735,127 @@ vec<N> operator-(const vec<N>& v) {
 }
 
 template<size_t N>
-vec<N> operator==(const vec<N>& lhs, const vec<N>& rhs) {
-    vec<N> res;
+vmask<N> operator==(const vec<N>& lhs, const vec<N>& rhs) {
+    vmask<N> res;
     for (auto i = 0; i < N; i++) res[i] = lhs[i] == rhs[i];
     return res;
 }
 
 template<size_t N>
-vec<N> operator==(float lhs, const vec<N>& rhs) { return vec<N>(lhs) == rhs; }
+vmask<N> operator==(float lhs, const vec<N>& rhs) { return vec<N>(lhs) == rhs; }
 
 template<size_t N>
-vec<N> operator==(const vec<N>& lhs, float rhs) { return rhs == lhs; }
+vmask<N> operator==(const vec<N>& lhs, float rhs) { return rhs == lhs; }
 
 template<size_t N>
-vec<N> operator<(const vec<N>& lhs, const vec<N>& rhs) {
-    vec<N> res;
+vmask<N> operator<(const vec<N>& lhs, const vec<N>& rhs) {
+    vmask<N> res;
     for (auto i = 0; i < N; i++) res[i] = lhs[i] < rhs[i];
     return res;
 }
 
 template<size_t N>
-vec<N> operator<(float lhs, const vec<N>& rhs) { return vec<N>(lhs) < rhs; }
+vmask<N> operator<(float lhs, const vec<N>& rhs) { return vec<N>(lhs) < rhs; }
 
 template<size_t N>
-vec<N> operator<(const vec<N>& lhs, float rhs) { return lhs < vec<N>(rhs); }
+vmask<N> operator<(const vec<N>& lhs, float rhs) { return lhs < vec<N>(rhs); }
 
 template<size_t N>
-vec<N> operator>(const vec<N>& lhs, const vec<N>& rhs) { return rhs < lhs; }
+vmask<N> operator>(const vec<N>& lhs, const vec<N>& rhs) { return rhs < lhs; }
 
 template<size_t N>
-vec<N> operator>(float lhs, const vec<N>& rhs) { return vec<N>(lhs) > rhs; }
+vmask<N> operator>(float lhs, const vec<N>& rhs) { return vec<N>(lhs) > rhs; }
 
 template<size_t N>
-vec<N> operator>(const vec<N>& lhs, float rhs) { return lhs > vec<N>(rhs); }
+vmask<N> operator>(const vec<N>& lhs, float rhs) { return lhs > vec<N>(rhs); }
 
 template<size_t N>
-vec<N> operator>=(const vec<N>& lhs, const vec<N>& rhs) {
-    vec<N> res;
+vmask<N> operator>=(const vec<N>& lhs, const vec<N>& rhs) {
+    vmask<N> res;
     for (auto i = 0; i < N; i++) res[i] = lhs[i] >= rhs[i];
     return res;
 }
 
 template<size_t N>
-vec<N> operator>=(float lhs, const vec<N>& rhs) { return vec<N>(lhs) >= rhs; }
+vmask<N> operator>=(float lhs, const vec<N>& rhs) { return vec<N>(lhs) >= rhs; }
+
+template<size_t N>
+vmask<N> operator>=(const vec<N>& lhs, float rhs) { return lhs >= vec<N>(rhs); }
+
+template<size_t N>
+vmask<N> operator<=(const vec<N>& lhs, const vec<N>& rhs) { return rhs >= lhs; }
+
+template<size_t N>
+vmask<N> operator<=(float lhs, const vec<N>& rhs) { return rhs >= lhs; }
+
+template<size_t N>
+vmask<N> operator<=(const vec<N>& lhs, float rhs) { return rhs >= lhs; }
 
 template<size_t N>
-vec<N> operator>=(const vec<N>& lhs, float rhs) { return lhs >= vec<N>(rhs); }
+vmask<N> operator&(const vmask<N>& lhs, const vmask<N>& rhs) {
+    vmask<N> res;
+    for (size_t i = 0; i < N; i++) res[i] = lhs[i] && rhs[i];
+    return res;
+}
+
+template<size_t N>
+vmask<N> operator|(const vmask<N>& lhs, const vmask<N>& rhs) {
+    vmask<N> res;
+    for (size_t i = 0; i < N; i++) res[i] = lhs[i] || rhs[i];
+    return res;
+}
+
+template<size_t N>
+vmask<N> operator~(const vmask<N>& m) {
+    vmask<N> res;
+    for (size_t i = 0; i < N; i++) res[i] = !m[i];
+    return res;
+}
+
+template<size_t N>
+unsigned int bits(const vmask<N>& m) {
+    unsigned int res = 0;
+    for (size_t i = 0; i < N; i++) res |= (unsigned int)m[i] << i;
+    return res;
+}
 
 template<size_t N>
-vec<N> operator<=(const vec<N>& lhs, const vec<N>& rhs) { return rhs >= lhs; }
+bool any(const vmask<N>& m) { return bits(m) != 0; }
 
 template<size_t N>
-vec<N> operator<=(float lhs, const vec<N>& rhs) { return rhs >= lhs; }
+bool all(const vmask<N>& m) { return bits(m) == (1ull << N) - 1; }
 
 template<size_t N>
-vec<N> operator<=(const vec<N>& lhs, float rhs) { return rhs >= lhs; }
+bool none(const vmask<N>& m) { return bits(m) == 0; }
+
+// number of lanes set
+template<size_t N>
+int count(const vmask<N>& m) { return __builtin_popcount(bits(m)); }
+
+// lhs in the lanes of m, rhs in the others
+template<size_t N>
+vec<N> select(const vmask<N>& m, const vec<N>& lhs, const vec<N>& rhs) {
+    vec<N> res;
+    for (size_t i = 0; i < N; i++) res[i] = m[i] ? lhs[i] : rhs[i];
+    return res;
+}
+
+template<size_t N>
+vec<N> select(const vmask<N>& m, float lhs, const vec<N>& rhs) { return select(m, vec<N>(lhs), rhs); }
+
+template<size_t N>
+vec<N> select(const vmask<N>& m, const vec<N>& lhs, float rhs) { return select(m, lhs, vec<N>(rhs)); }
+
+// lhs + rhs in the lanes of m, lhs in the others
+template<size_t N>
+vec<N> masked_add(const vmask<N>& m, const vec<N>& lhs, const vec<N>& rhs) {
+    vec<N> res;
+    for (size_t i = 0; i < N; i++) res[i] = m[i] ? lhs[i] + rhs[i] : lhs[i];
+    return res;
+}
+
+template<size_t N>
+vec<N> masked_add(const vmask<N>& m, const vec<N>& lhs, float rhs) { return masked_add(m, lhs, vec<N>(rhs)); }
 
 template<size_t N>
 vec<N> operator+(const vec<N>& lhs, const vec<N>& rhs) { 
@@ -321,6 +922,11 @@ vec<N> mul_add(const vec<N>& v, const vec<N>& w, const vec<N>& z) {
     return v * w + z;
 }
 
+template<size_t N>
+vec<N> mul_add(const vec<N>& v, float w, const vec<N>& z) { 
+    return mul_add(v, vec<N>(w), z);
+}
+
 template<size_t N>
 vec<N> max(const vec<N>& v, const vec<N>& w) { 
     vec<N> res;
@@ -333,6 +939,11 @@ vec<N> max(const vec<N>& lhs, float rhs) {
     return max(lhs, vec<N>(rhs));
 }
 
+template<size_t N>
+vec<N> max(float lhs, const vec<N>& rhs) { 
+    return max(vec<N>(lhs), rhs);
+}
+
 template<size_t N>
 vec<N> min(const vec<N>& v, const vec<N>& w) { 
     vec<N> res;
@@ -345,6 +956,11 @@ vec<N> min(const vec<N>& lhs, float rhs) {
     return min(lhs, vec<N>(rhs));
 }
 
+template<size_t N>
+vec<N> min(float lhs, const vec<N>& rhs) { 
+    return min(vec<N>(lhs), rhs);
+}
+
 template<size_t N>
 vec<N> clamp(const vec<N>& v, float lo, float hi) { 
     vec<N> res;
@@ -352,6 +968,21 @@ vec<N> clamp(const vec<N>& v, float lo, float hi) {
     return res;
 }
 
+template<size_t N>
+vec<N> floor(const vec<N>& v) { 
+    vec<N> res;
+    for (auto i = 0; i < N; i++) res[i] = floorf(v[i]);
+    return res;
+}
+
+// base[indices[i]] in lane i, the indices being whole numbers below 2^24
+template<size_t N>
+vec<N> gather(const float* base, const vec<N>& indices) { 
+    vec<N> res;
+    for (auto i = 0; i < N; i++) res[i] = base[int(indices[i])];
+    return res;
+}
+
 template<size_t N>
 vec<N> abs(const vec<N>& v) { 
     vec<N> res;
@@ -385,6 +1016,46 @@ vec<N> normalize(const vec<N>& v) {
     return v/vlen;
 }
 
+template<size_t N>
+vec<N> sin(const vec<N>& v) { 
+    vec<N> res;
+    for (auto i = 0; i < N; i++) res[i] = sinf(v[i]);
+    return res;
+}
+
+template<size_t N>
+vec<N> cos(const vec<N>& v) { 
+    vec<N> res;
+    for (auto i = 0; i < N; i++) res[i] = cosf(v[i]);
+    return res;
+}
+
+template<size_t N>
+void sincos(const vec<N>& v, vec<N>& s, vec<N>& c) { 
+    s = sin(v);
+    c = cos(v);
+}
+
+// the scalar one, for the code written for both floats and vecs
+void sincos(float v, float& s, float& c) {
+    s = sinf(v);
+    c = cosf(v);
+}
+
+template<size_t N>
+vec<N> atan2(const vec<N>& y, const vec<N>& x) { 
+    vec<N> res;
+    for (auto i = 0; i < N; i++) res[i] = atan2f(y[i], x[i]);
+    return res;
+}
+
+template<size_t N>
+vec<N> rsqrt(const vec<N>& v) { 
+    vec<N> res;
+    for (auto i = 0; i < N; i++) res[i] = 1.0f / sqrtf(v[i]);
+    return res;
+}
+
 template<size_t N>
 vec<N> sqrt(const vec<N>& v) { 
     vec<N> res;
@@ -392,6 +1063,13 @@ vec<N> sqrt(const vec<N>& v) {
     return res;
 }
 
+template<size_t N>
+vec<N> exp(const vec<N>& v) { 
+    vec<N> res;
+    for (auto i = 0; i < N; i++) res[i] = expf(v[i]);
+    return res;
+}
+
 template<size_t N>
 vec<N> interp(const vec<N>& v, const vec<N>& w, float a) { 
     vec<N> res;
@@ -240,6 +240,14 @@ vecpack<N_vecs, vec_N> mul_add(const vecpack<N_vecs, vec_N>& a, const vecpack<N_
     return res;
 }
 
+// lhs in the lanes of m, rhs in the others
+template<size_t N_vecs, size_t vec_N>
+vecpack<N_vecs, vec_N> select(const vmask<N_vecs>& m, const vecpack<N_vecs, vec_N>& lhs, const vecpack<N_vecs, vec_N>& rhs) { 
+    vecpack<N_vecs, vec_N> res;
+    for (size_t i = 0; i < vec_N; i++) res[i] = select(m, lhs[i], rhs[i]);
+    return res;
+}
+
 template<size_t N_vecs, size_t vec_N>
 vecpack<N_vecs, vec_N> apply(const vecpack<N_vecs, vec_N>& v, float (&func) (float)) { 
     vecpack<N_vecs, vec_N> res;
@@ -275,15 +283,15 @@ vec<N_vecs> len(const vecpack<N_vecs, vec_N>& v) {
 
 template<size_t N_vecs, size_t vec_N>
 vec<N_vecs> dot(const vecpack<N_vecs, vec_N>& lhs, const vecpack<N_vecs, vec_N>& rhs) { 
-    vec<N_vecs> res(0.0f);
-    for (auto i = 0; i < vec_N; i++) res = res + lhs[i] * rhs[i];
+    vec<N_vecs> res = lhs[0] * rhs[0];
+    for (size_t i = 1; i < vec_N; i++) res = mul_add(lhs[i], rhs[i], res);
     return res;
 }
 
 template<size_t N_vecs, size_t vec_N>
 vec<N_vecs> dot(const vecpack<N_vecs, vec_N>& lhs, const vec<vec_N>& rhs) { 
-    vec<N_vecs> res(0.0f);
-    for (auto i = 0; i < vec_N; i++) res = res + lhs[i] * rhs[i];
+    vec<N_vecs> res = lhs[0] * rhs[0];
+    for (size_t i = 1; i < vec_N; i++) res = mul_add(lhs[i], vec<N_vecs>(rhs[i]), res);
     return res;
 }
 
@@ -308,6 +316,20 @@ vecpack<N_vecs, vec_N> interp(const vecpack<N_vecs, vec_N>& v, const vecpack<N_v
     return res;
 }
 
+template<size_t N_vecs, size_t vec_N>
+vecpack<N_vecs, vec_N> sin(const vecpack<N_vecs, vec_N>& v) { 
+    vecpack<N_vecs, vec_N> res;
+    for (auto i = 0; i < vec_N; i++) res[i] = sin(v[i]);
+    return res;
+}
+
+template<size_t N_vecs, size_t vec_N>
+vecpack<N_vecs, vec_N> cos(const vecpack<N_vecs, vec_N>& v) { 
+    vecpack<N_vecs, vec_N> res;
+    for (auto i = 0; i < vec_N; i++) res[i] = cos(v[i]);
+    return res;
+}
+
 template<size_t N_vecs, size_t vec_N>
 vecpack<N_vecs, vec_N> pow(const vecpack<N_vecs, vec_N>& v, float a) { 
     vecpack<N_vecs, vec_N> res;
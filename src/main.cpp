@@ -1,121 +1,39 @@
-#include <cmath>
-#include <tuple>
+#include <SDL2/SDL.h>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
-#include <iomanip>
-#include <array>
-#include <thread>
-#include <vector>
 
-#include "distances.hpp"
-#include "transformations.hpp"
-#include "linalg/mat3.hpp"
-#include "linalg/vec.hpp"
-#include "linalg/vecpack.hpp"
+// the program is built once per instruction set in isa/, the widest one the cpu supports is run
+namespace sse42 { int run(int argc, char** argv); }
+namespace avx2 { int run(int argc, char** argv); }
+namespace avx512 { int run(int argc, char** argv); }
 
-#include "screen.hpp"
-#include "scenes/simple_scene.hpp"
-#include "scenes/cooler_scene.hpp"
-#include "camera.hpp"
-#include "painter.hpp"
-#include "shader.hpp"
-#include "controls.hpp"
-#include "performance_monitor.hpp"
+struct isa {
+    const char* name;
+    bool supported;
+    int (*run)(int argc, char** argv);
+};
 
+int main(int argc, char** argv) {
+    __builtin_cpu_init();
 
-#define SIMD
-#define MULTITHREADED
+    const isa isas[] = {
+        { "avx512", __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"), avx512::run },
+        { "avx2", __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"), avx2::run },
+        { "sse42", bool(__builtin_cpu_supports("sse4.2")), sse42::run },
+    };
 
-#define DEF_RENDER_THREAD(i) \
-    Painter<dimx, dimy, i*pixels_per_thread, (i+1)*pixels_per_thread> painter##i(&screen, &shader);\
-    std::thread t##i(painter_thread<dimx, dimy, i*pixels_per_thread, (i+1)*pixels_per_thread>, &painter##i, &state.quit);
+    // the GEORGES_ISA environment variable can ask for a narrower instruction set than the best one
+    const char* requested = std::getenv("GEORGES_ISA");
 
-template<size_t screen_width, size_t screen_height, size_t min_offset, size_t max_offset>
-void painter_thread(Painter<screen_width, screen_height, min_offset, max_offset>* painter, const bool* quit) {
-    while (!*quit) {
-        #ifdef SIMD
-        painter->paint_simd(1000);
-        #else
-        painter->paint(8000);
-        #endif
-    }
-}
-
-int main() {
-    constexpr auto dimx = 1280u, dimy = 720u;
-    const vec2 dim(dimx, dimy);
-
-    const float walk_speed = 0.2f;
-    const float turn_speed = 0.05f;
-    vec3 walk_dir;
-
-    ShaderConfig shader_config;    
-    shader_config.max_dist = 10000.0f;
-    shader_config.max_its = 256;
-    shader_config.light_dir = normalize(vec3(-0.2, 0.2, 0));
-    shader_config.background_color = vec3(0.4,0.56,0.97);
-    shader_config.time = 0.0f;
-
-    CoolerScene scene;
-
-    Screen<dimx, dimy> screen;
-    Camera camera(45.0f, dim, vec3(0.0, 1.0, 0.0), -M_PI);
-    Shader shader(&shader_config, &camera, &scene);
-    Painter<dimx, dimy, 0, dimx * dimy> painter(&screen, &shader);
-    PerformanceMonitor perf(2);
-    controles_state state;
-    
-    #ifdef SIMD
-    const char* title = "SIMD implementation";
-    #else
-    const char* title = "Reference implementation";
-    #endif
-
-    if (!screen.initialize(title)) return -1;
+    for (const isa& candidate : isas) {
+        if (!candidate.supported) continue;
+        if (requested && std::strcmp(requested, candidate.name) != 0) continue;
 
-    std::cout << "RUNNING: " << title << std::endl;
-    
-    // some template magic could probably help me run this loop sort of statically
-    // otherwise the template parameter is not proper
-    #ifdef MULTITHREADED
-    constexpr size_t num_threads = 8;	
-    constexpr size_t pixels_per_thread = dimx * dimy / num_threads;	
-
-    DEF_RENDER_THREAD(0); DEF_RENDER_THREAD(1);
-    DEF_RENDER_THREAD(2); DEF_RENDER_THREAD(3);
-    DEF_RENDER_THREAD(4); DEF_RENDER_THREAD(5);
-    DEF_RENDER_THREAD(6); DEF_RENDER_THREAD(7);
-    #endif
-
-    while(!state.quit) {
-        poll_state(state);
-
-        camera.turn((state.left - state.right) * turn_speed);
-
-        walk_dir = vec3(0, 0, (state.down - state.up) * walk_speed);
-        camera.move_forward(walk_dir);
-
-        #ifdef MULTITHREADED
-        screen.sleep(18);
-        shader_config.time += 18;
-        #else
-        perf.tick();
-
-        #ifdef SIMD
-        painter.paint_simd(1000);
-        #else
-        painter.paint(8000);
-        #endif
-        
-        shader_config.time += perf.tock();
-        #endif
-
-        screen.render();
+        std::cout << "ISA: " << candidate.name << std::endl;
+        return candidate.run(argc, argv);
     }
 
-    #ifdef MULTITHREADED
-    t0.join(); t1.join(); t2.join(); t3.join();
-    t4.join(); t5.join(); t6.join(); t7.join();
-    #endif
-
-    return EXIT_SUCCESS;
+    std::cout << "No supported instruction set" << (requested ? " matches GEORGES_ISA" : "") << std::endl;
+    return EXIT_FAILURE;
 }
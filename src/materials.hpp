@@ -0,0 +1,87 @@
+#ifndef MATERIALS_HPP
+#define MATERIALS_HPP
+
+#include <cmath>
+#include <tuple>
+
+#include "linalg/vec.hpp"
+#include "linalg/vecpack.hpp"
+
+// Materials give the color of a surface at a point, or at a pack of points.
+
+struct Flat {
+    vec3 color;
+
+    vec3 operator()(const vec3& p) const {
+        return color;
+    }
+
+    template<size_t N>
+    vecpack<N, 3> operator()(const vecpack<N, 3>& p) const {
+        return vecpack<N, 3>(color);
+    }
+};
+
+// squares of side size alternating on the xz plane, even holding the origin's
+struct Checkerboard {
+    vec3 even, odd;
+    float size;
+
+    vec3 operator()(const vec3& p) const {
+        const float squares = std::floor(p[0] / size) + std::floor(p[2] / size);
+        return squares - 2.0f * std::floor(0.5f * squares) < 0.5f ? even : odd;
+    }
+
+    template<size_t N>
+    vecpack<N, 3> operator()(const vecpack<N, 3>& p) const {
+        const vec<N> squares = floor(p[0] * (1.0f / size)) + floor(p[2] * (1.0f / size));
+        return select(squares - 2.0f * floor(0.5f * squares) < 0.5f, vecpack<N, 3>(even), vecpack<N, 3>(odd));
+    }
+};
+
+// The materials of a scene, indexed by the ids given to the material nodes of its distance
+// field, see sdf.hpp. On packs, each material is evaluated once for the lanes having its id,
+// and skipped when none has it, so that scenes with many materials stay on the simd path.
+template<typename... Materials>
+class MaterialTable {
+    public:
+    MaterialTable(const Materials&... materials) : materials(materials...) {}
+
+    template<size_t I = 0>
+    vec3 color(int id, const vec3& p) const;
+
+    template<size_t I = 0, size_t N>
+    vecpack<N, 3> color(const vec<N>& ids, const vecpack<N, 3>& p) const;
+
+    // the color of ids without a material
+    static vec3 missing() {
+        return vec3(0.0f, 1.0f, 0.0f);
+    }
+
+    private:
+    std::tuple<Materials...> materials;
+};
+
+template<typename... Materials>
+template<size_t I>
+vec3 MaterialTable<Materials...>::color(int id, const vec3& p) const {
+    if constexpr (I == sizeof...(Materials)) {
+        return missing();
+    } else {
+        return id == I ? std::get<I>(materials)(p) : color<I + 1>(id, p);
+    }
+}
+
+template<typename... Materials>
+template<size_t I, size_t N>
+vecpack<N, 3> MaterialTable<Materials...>::color(const vec<N>& ids, const vecpack<N, 3>& p) const {
+    if constexpr (I == sizeof...(Materials)) {
+        return vecpack<N, 3>(missing());
+    } else {
+        const vecpack<N, 3> others = color<I + 1>(ids, p);
+        const vmask<N> m = ids == vec<N>(float(I));
+        return any(m) ? select(m, std::get<I>(materials)(p), others) : others;
+    }
+}
+
+#endif
@@ -1,46 +1,143 @@
 #ifndef PAINTER_HPP
 #define PAINTER_HPP
 
+#include <algorithm>
 #include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <vector>
 
+#include "depth_cache.hpp"
+#include "random.hpp"
 #include "screen.hpp"
 #include "shader.hpp"
+#include "thread_pool.hpp"
 #include "types.hpp"
 
-template<size_t screen_width, size_t screen_height, size_t min_offset, size_t max_offset>
+// order in which the progressive painters pick the pixels of their band
+enum class PixelOrder {
+    // independent uniform picks
+    random,
+    // R2 low-discrepancy sequence snapped to the band, visits every pixel once per cycle
+    r2,
+};
+
+// Paints the rows [min_row, max_row) of the screen, clamped to its render size.
+// The frame painters pick up the render size at the start of every frame, the
+// progressive painters keep the one the screen had when they were created.
+template<typename ShaderType>
 class Painter {
     public:
-    Painter(Screen<screen_width, screen_height>* screen, const Shader* shader) : screen(screen), shader(shader) {}
+    Painter(Screen* screen, const ShaderType* shader,
+            size_t min_row = 0, size_t max_row = SIZE_MAX, PixelOrder order = PixelOrder::random) :
+        screen(screen), shader(shader),
+        width(screen->render_width()), height(screen->render_height()),
+        min_row(min_row), max_row(max_row),
+        min_offset(std::min(min_row, height) * width), max_offset(std::min(max_row, height) * width),
+        num_pixels_covered(max_offset - min_offset),
+        order(order), rng(0x853c49e6748fea9bULL, min_row),
+        r2_stride(r2_band_stride(num_pixels_covered / width, width)), r2_cursor(0),
+        depth_cache(nullptr), cone_prepass(false), interval_culling(false) {}
+
+    // the simd tile painters start their rays from the cache's reprojected distances
+    // and record their hits into it, the cache must be fed with begin_frame by the caller.
+    // The distances are not bounds: rays may step over surfaces, see DepthCache.
+    void set_depth_cache(DepthCache* cache) {
+        depth_cache = cache;
+    }
+
+    // Before painting, the simd frame painters march one cone per tile and then, from there,
+    // one cone per shaded row of the tile. The rays of a row start where its cone stopped.
+    void set_cone_prepass(bool enabled) {
+        cone_prepass = enabled;
+    }
+
+    // Before painting, and before the cones, the simd frame painters bound the distance field over
+    // the frustum of each tile to skip the depths proven empty, and the whole tile when it sees only sky.
+    void set_interval_culling(bool enabled) {
+        interval_culling = enabled;
+    }
+
+    // coarsest stride accepted by the frame painters
+    static constexpr size_t max_stride = 4;
+    // tiles are at least a vecpack wide
+    static constexpr size_t tile_size = std::max<size_t>(8, simd_width);
+
+    // Paints every pixel of the band exactly once, tile by tile. With a stride of s,
+    // only one pixel out of each s x s block is shaded and its color fills the block.
+    void paint_frame(size_t stride = 1) {
+        fit_render_size();
+        for (size_t tile = 0; tile < num_tiles(stride); tile++) paint_tile(tile, stride);
+    }
+
+    void paint_frame_simd(size_t stride = 1) {
+        fit_render_size();
+        march_tile_starts(nullptr, stride);
+        for (size_t tile = 0; tile < num_tiles(stride); tile++) paint_tile_simd(tile, stride);
+    }
+
+    // same, with the tiles shared between the workers of the pool. Returns as soon as
+    // the tiles are queued, after the tile prepasses if any, pool->wait() blocks until the frame is done.
+    void dispatch_frame(ThreadPool* pool, size_t stride = 1) {
+        fit_render_size();
+        pool->dispatch(num_tiles(stride), [this, stride](size_t tile) { paint_tile(tile, stride); });
+    }
+
+    void dispatch_frame_simd(ThreadPool* pool, size_t stride = 1) {
+        fit_render_size();
+        march_tile_starts(pool, stride);
+        pool->dispatch(num_tiles(stride), [this, stride](size_t tile) { paint_tile_simd(tile, stride); });
+    }
+
+    // tiles are tile_size x tile_size shaded pixels, i.e. cover (stride * tile_size)^2 pixels.
+    // Tiles are cut at the bottom of the band, but not at the right of the screen:
+    // the render width must be a multiple of width_multiple, which fit_render_size asserts.
+    size_t num_tiles(size_t stride = 1) const {
+        const size_t tile_rows = (last_row() - std::min(min_row, last_row()) + stride * tile_size - 1) / (stride * tile_size);
+        return tiles_per_row(stride) * tile_rows;
+    }
+
+    void paint_tile(size_t tile, size_t stride = 1) {
+        paint_tile(tile_x(tile, stride), tile_y(tile, stride), stride);
+    }
+
+    void paint_tile_simd(size_t tile, size_t stride = 1) {
+        const float start = cone_prepass || interval_culling ? tile_start[tile] : DepthCache::near_plane;
+        paint_tile_simd(tile_x(tile, stride), tile_y(tile, stride), stride, start);
+    }
 
     void paint(size_t num_pixels) {
-        size_t local_offset, offset, x, y;
+        // a band below the render height has no pixel to pick
+        if (num_pixels_covered == 0) return;
+        size_t offset, x, y;
 
         for (auto i = 0; i < num_pixels; i++) {
-            local_offset = rand() % num_pixels_covered;
-            offset = min_offset + local_offset;
+            offset = next_offset();
 
-            x = offset % screen_width;
-            y = (offset - x) / screen_width;
+            x = offset % width;
+            y = (offset - x) / width;
 
-            color c = shader-> render_pixel(x, screen_height - y - 1);
+            color c = shader-> render_pixel(x, height - y - 1);
             splash_color(x, y, c);
         }
     }
 
     void paint_simd(size_t num_packs) {
-        size_t local_offset, offset, x, y;
+        if (num_pixels_covered == 0) return;
+        size_t offset, x, y;
 
         for (auto i = 0; i < num_packs; i++) {
-            vecpack<8, 2> pixels;
-            std::array<float, 8> xs, ys;
-            std::array<size_t, 8 * 2> coordinates;
+            vecpack<simd_width, 2> pixels;
+            std::array<float, simd_width> xs, ys;
+            std::array<size_t, simd_width * 2> coordinates;
 
-            for (auto i = 0; i < 8; i++) {
-                local_offset = rand() % num_pixels_covered;
-                offset = min_offset + local_offset;
+            for (size_t i = 0; i < simd_width; i++) {
+                offset = next_offset();
 
-                x = offset % screen_width;
-                y = (offset - x) / screen_width;
+                x = offset % width;
+                y = (offset - x) / width;
 
                 coordinates[i*2] = x;
                 coordinates[i*2+1] = y;
@@ -51,14 +148,192 @@ class Painter {
             pixels[0] = xs;
             pixels[1] = ys;
 
-            std::array<color, 8> c = shader->render_pixel_simd(pixels);
-            for (auto i = 0; i < 8; i++) {
-                splash_color(coordinates[i*2], screen_height - 1 -  coordinates[i*2+1], c[i]);
+            std::array<color, simd_width> c = shader->render_pixel_simd(pixels);
+            for (size_t i = 0; i < simd_width; i++) {
+                splash_color(coordinates[i*2], height - 1 -  coordinates[i*2+1], c[i]);
+            }
+        }
+    }
+
+    // shaded pixels per tile row, the render width must be a multiple of it for whole rows to be painted
+    static constexpr size_t width_multiple = max_stride * tile_size;
+
+    private:
+    void fit_render_size() {
+        width = screen->render_width();
+        height = screen->render_height();
+        assert(width % width_multiple == 0);
+    }
+
+    size_t last_row() const {
+        return std::min(max_row, height);
+    }
+
+    void paint_tile(size_t tx, size_t ty, size_t stride) {
+        const size_t max_y = std::min(ty + stride * tile_size, last_row());
+
+        for (size_t y = ty; y < max_y; y += stride) {
+            for (size_t x = tx; x < tx + stride * tile_size; x += stride) {
+                fill_block(x, y, stride, shader->render_pixel(x, height - y - 1));
+            }
+        }
+    }
+
+    void paint_tile_simd(size_t tx, size_t ty, size_t stride, float start) {
+        const size_t max_y = std::min(ty + stride * tile_size, last_row());
+        vecpack<simd_width, 2> pixels;
+        std::array<float, simd_width> xs;
+        std::array<color, simd_width> c;
+
+        // the row cones are marched simd_width at a time, from the tile's cone. Tiles proven to see
+        // only sky have none, their rays all start past max_dist and are shaded as misses unmarched.
+        std::array<float, tile_size> row_start;
+        row_start.fill(start);
+        if (cone_prepass && !shader->escaped(start)) {
+            const float half_span = 0.5f * (tile_size - 1) * stride;
+            std::array<float, simd_width> ys;
+
+            for (size_t row = 0; row < tile_size; row += simd_width) {
+                for (size_t i = 0; i < simd_width; i++) ys[i] = camera_row(ty + (row + i) * stride);
+                pixels[0] = tx + half_span;
+                pixels[1] = ys;
+
+                std::array<float, simd_width> cone_start = shader->cone_march_simd(pixels, half_span, start);
+                std::copy(cone_start.begin(), cone_start.end(), row_start.begin() + row);
+            }
+        }
+
+        // the rays of the whole tile are marched as one stream, then shaded pack by pack
+        std::array<vecpack<simd_width, 2>, packs_per_tile> packs;
+        std::array<vec<simd_width>, packs_per_tile> guess, hit_time, hit_texture;
+        std::array<float, packs_per_tile> safe_start{};
+        size_t num_packs = 0;
+
+        for (size_t y = ty, row = 0; y < max_y; y += stride, row++) {
+            const size_t camera_y = height - y - 1;
+
+            for (size_t x = tx; x < tx + stride * tile_size; x += simd_width * stride, num_packs++) {
+                for (size_t i = 0; i < simd_width; i++) xs[i] = x + i * stride;
+                packs[num_packs][0] = xs;
+                packs[num_packs][1] = camera_y;
+
+                safe_start[num_packs] = row_start[row];
+                guess[num_packs] = depth_cache ? max(depth_cache->start_distance(x, camera_y, stride), row_start[row]) : vec<simd_width>(row_start[row]);
             }
         }
+
+        shader->march_stream_simd(num_packs, packs, guess, safe_start, hit_time, hit_texture);
+
+        size_t pack = 0;
+        for (size_t y = ty; y < max_y; y += stride) {
+            const size_t camera_y = height - y - 1;
+            const size_t block_rows = std::min(stride, max_y - y);
+
+            for (size_t x = tx; x < tx + stride * tile_size; x += simd_width * stride, pack++) {
+                c = shader->shade_pixel_simd(packs[pack], hit_time[pack], hit_texture[pack]);
+
+                if (depth_cache) {
+                    for (size_t dy = 0; dy < block_rows; dy++) depth_cache->record(x, camera_y - dy, hit_time[pack], stride);
+                }
+
+                for (size_t i = 0; i < simd_width; i++) {
+                    fill_block(x + i * stride, y, stride, c[i]);
+                }
+            }
+        }
+    }
+
+    // the start of the rays of each tile, from its interval march then its cone, the cones of
+    // simd_width consecutive tiles being marched together
+    void march_tile_starts(ThreadPool* pool, size_t stride) {
+        if (!cone_prepass && !interval_culling) return;
+
+        tile_start.resize(num_tiles(stride));
+        const size_t num_packs = (tile_start.size() + simd_width - 1) / simd_width;
+
+        if (pool) {
+            pool->run(num_packs, [this, stride](size_t pack) { march_tile_starts(simd_width * pack, stride); });
+        } else {
+            for (size_t pack = 0; pack < num_packs; pack++) march_tile_starts(simd_width * pack, stride);
+        }
+    }
+
+    void march_tile_starts(size_t first_tile, size_t stride) {
+        const float half_span = 0.5f * (tile_size - 1) * stride;
+        const size_t count = std::min<size_t>(simd_width, tile_start.size() - first_tile);
+        vecpack<simd_width, 2> centers;
+        std::array<float, simd_width> xs, ys;
+
+        // lanes past the last tile march a copy of it
+        for (size_t i = 0; i < simd_width; i++) {
+            const size_t tile = first_tile + std::min(i, count - 1);
+            xs[i] = tile_x(tile, stride) + half_span;
+            ys[i] = camera_row(tile_y(tile, stride)) - half_span;
+        }
+        centers[0] = xs;
+        centers[1] = ys;
+
+        // the cone of a tile contains the rays through its corners, and so does its frustum
+        const float radius = std::sqrt(2.0f) * half_span;
+        std::array<float, simd_width> start;
+        start.fill(DepthCache::near_plane);
+        if (interval_culling) {
+            for (size_t i = 0; i < count; i++) start[i] = shader->interval_march(vec2(xs[i], ys[i]), radius, start[i]);
+            std::fill(start.begin() + count, start.end(), start[count - 1]);
+        }
+        if (cone_prepass) start = shader->cone_march_simd(centers, radius, start);
+        std::copy_n(start.begin(), count, tile_start.begin() + first_tile);
+    }
+
+    size_t tile_x(size_t tile, size_t stride) const {
+        return stride * tile_size * (tile % tiles_per_row(stride));
+    }
+
+    size_t tile_y(size_t tile, size_t stride) const {
+        return min_row + stride * tile_size * (tile / tiles_per_row(stride));
+    }
+
+    // the shader's rows go up the screen. Cones may reach below the screen, as they
+    // cover every row of the tile, hence the signed result.
+    float camera_row(size_t y) const {
+        return float(height) - float(y) - 1.0f;
+    }
+
+    void fill_block(size_t x, size_t y, size_t stride, const color& c) {
+        const size_t max_y = std::min(y + stride, last_row());
+
+        for (size_t by = y; by < max_y; by++) {
+            for (size_t bx = x; bx < x + stride; bx++) screen->put_pixel(bx, by, c);
+        }
+    }
+
+    size_t tiles_per_row(size_t stride) const {
+        return width / (stride * tile_size);
+    }
+
+    size_t next_offset() {
+        if (order == PixelOrder::r2) {
+            r2_cursor += r2_stride;
+            if (r2_cursor >= num_pixels_covered) r2_cursor -= num_pixels_covered;
+            return min_offset + r2_cursor;
+        }
+        return min_offset + rng.next(num_pixels_covered);
+    }
+
+    // Stepping through the band by (rows / g^2) rows and (width / g) columns at a time,
+    // g being the plastic number, follows the R2 sequence (x_n = n / g, y_n = n / g^2 mod 1).
+    // The stride is made coprime with the band size so that the walk is a permutation.
+    static size_t r2_band_stride(size_t rows, size_t width) {
+        const double g = 1.32471795724474602596;
+        const size_t num_pixels = rows * width;
+        if (num_pixels < 2) return 0;
+
+        size_t stride = std::lround(rows / (g * g)) * width + std::lround(width / g);
+
+        while (std::gcd(stride, num_pixels) != 1) stride++;
+        return stride % num_pixels;
     }
 
-    private:    
     void splash_color(size_t x, size_t y, const color& c) {
         screen->put_pixel(x, y, c);
         if (is_covered(x-1, y)) screen->put_pixel(x-1, y, c);
@@ -68,13 +343,32 @@ class Painter {
     }
 
     inline bool is_covered(size_t x, size_t y) const {
-        const size_t offset = screen_width * y + x;
+        const size_t offset = width * y + x;
         return min_offset <= offset && offset < max_offset;
     }
 
-    static constexpr size_t num_pixels_covered = max_offset - min_offset;
-    Screen<screen_width, screen_height>* screen;
-    const Shader* shader;
+    // one vecpack<simd_width, 2> is a contiguous row segment of a tile
+    static_assert(tile_size % simd_width == 0, "tiles must be made of whole vecpacks");
+    static constexpr size_t packs_per_tile = tile_size * tile_size / simd_width;
+
+    Screen* screen;
+    const ShaderType* shader;
+
+    size_t width, height;
+    const size_t min_row, max_row;
+    const size_t min_offset, max_offset;
+    const size_t num_pixels_covered;
+
+    const PixelOrder order;
+    PCG32 rng;
+    const size_t r2_stride;
+    size_t r2_cursor;
+
+    DepthCache* depth_cache;
+
+    bool cone_prepass, interval_culling;
+    // start distance per tile of the current frame
+    std::vector<float> tile_start;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,35 @@
+#ifndef RANDOM_HPP
+#define RANDOM_HPP
+
+#include <cstdint>
+
+// PCG32 (O'Neill, pcg-random.org). The state is a plain member, so each thread owning
+// a generator draws numbers without any locking, unlike libc's rand().
+class PCG32 {
+    public:
+    PCG32(uint64_t seed, uint64_t stream = 0) : state(0), increment((stream << 1u) | 1u) {
+        next();
+        state += seed;
+        next();
+    }
+
+    uint32_t next() {
+        const uint64_t old = state;
+        state = old * 6364136223846793005ULL + increment;
+
+        const uint32_t xorshifted = ((old >> 18u) ^ old) >> 27u;
+        const uint32_t rot = old >> 59u;
+        return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+    }
+
+    // uniform in [0, bound) using a multiply-shift instead of a division
+    uint32_t next(uint32_t bound) {
+        return (static_cast<uint64_t>(next()) * bound) >> 32;
+    }
+
+    private:
+    uint64_t state;
+    uint64_t increment;
+};
+
+#endif
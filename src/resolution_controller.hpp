@@ -0,0 +1,74 @@
+#ifndef RESOLUTION_CONTROLLER_HPP
+#define RESOLUTION_CONTROLLER_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+// Picks the render resolution from the measured frame times so as to hold a frame time budget.
+// The cost of a frame is taken to be proportional to its number of pixels: a frame taking k times
+// the budget asks for the resolution to be scaled by 1 / sqrt(k) along both axes.
+class ResolutionController {
+    public:
+    // the resolution keeps the aspect ratio of max_width x max_height, with widths
+    // rounded to multiples of width_multiple, max_width itself being rounded down
+    ResolutionController(size_t max_width, size_t max_height, float target_seconds, size_t width_multiple) :
+        max_width(max_width), max_height(max_height),
+        target_seconds(target_seconds), width_multiple(width_multiple),
+        widest(max_width / width_multiple * width_multiple),
+        average_seconds(target_seconds),
+        current_width(widest), current_height(fit_height(widest)) {
+        assert(widest > 0);
+    }
+
+    // feeds the duration of a frame rendered at the current resolution,
+    // returns whether the resolution changed
+    bool update(float frame_seconds) {
+        average_seconds += smoothing * (frame_seconds - average_seconds);
+
+        // within the tolerance, the quantized resolution would only flicker around the budget
+        const float ratio = target_seconds / average_seconds;
+        if (std::abs(ratio - 1.0f) < tolerance) return false;
+
+        const float scale = std::clamp(std::sqrt(ratio) * current_width / max_width, min_scale, 1.0f);
+        const size_t width = std::clamp<size_t>(std::lround(scale * max_width / width_multiple) * width_multiple, width_multiple, widest);
+        const size_t height = fit_height(width);
+        if (width == current_width && height == current_height) return false;
+
+        // the average is carried over to the new resolution, so that the next
+        // frames are not judged on the old resolution's times
+        average_seconds *= float(width * height) / (current_width * current_height);
+
+        current_width = width;
+        current_height = height;
+        return true;
+    }
+
+    size_t width() const {
+        return current_width;
+    }
+
+    size_t height() const {
+        return current_height;
+    }
+
+    static constexpr float min_scale = 0.25f;
+    static constexpr float smoothing = 0.1f;
+    static constexpr float tolerance = 0.05f;
+
+    private:
+    size_t fit_height(size_t width) const {
+        return std::min<size_t>(max_height, std::lround(float(width) * max_height / max_width));
+    }
+
+    const size_t max_width, max_height;
+    const float target_seconds;
+    const size_t width_multiple;
+    // the widest multiple of width_multiple within max_width
+    const size_t widest;
+
+    float average_seconds;
+    size_t current_width, current_height;
+};
+
+#endif
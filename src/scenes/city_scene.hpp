@@ -0,0 +1,36 @@
+#ifndef CITY_SCENE_HPP
+#define CITY_SCENE_HPP
+
+#include "sdf_scene.hpp"
+
+enum CityMaterial { city_building, city_floor, city_roof };
+
+// endless blocks of buildings along streets with a ring of pillars on their roofs, a single
+// building repeated over the floor. It is centered in its cell, which is the closest one.
+// Near the viewpoint the walls are rough, farther away they are plain boxes.
+auto city_field() {
+    const auto walls = translate(vec3(0.0f, 1.5f, 0.0f), box(vec3(1.4f, 1.5f, 1.4f)));
+    const auto pillars = polar_repeat(8, translate(vec3(1.0f, 3.3f, 0.0f), box(vec3(0.1f, 0.3f, 0.1f))));
+    const auto city = [&pillars](const auto& building) {
+        return unite(material(city_floor, plane(vec3(0, 1, 0), 0)),
+            translate(vec3(2.0f, 0.0f, 2.0f), repeat(vec3(4.0f, 0.0f, 4.0f),
+                unite(material(city_building, building), material(city_roof, pillars)))));
+    };
+    // the rough walls are within the displacement's amount of the plain ones
+    const float roughness = 0.02f;
+    return lod(12.0f, 20.0f, roughness, city(displace(roughness, walls)), city(walls));
+}
+
+auto city_materials() {
+    return MaterialTable(
+        Flat{ vec3(0.45f, 0.42f, 0.4f) },
+        Checkerboard{ vec3(0.3f, 0.3f, 0.3f), vec3(0.2f, 0.2f, 0.2f), 1.0f },
+        Flat{ vec3(0.6f, 0.15f, 0.1f) });
+}
+
+class CityScene final : public SdfScene<decltype(city_field()), decltype(city_materials())> {
+    public:
+    CityScene() : SdfScene(city_field(), city_materials()) {}
+};
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef CROWD_SCENE_HPP
+#define CROWD_SCENE_HPP
+
+#include <vector>
+
+#include "../brick_map.hpp"
+#include "../bvh.hpp"
+#include "../random.hpp"
+#include "sdf_scene.hpp"
+
+enum CrowdMaterial { crowd_primitive, crowd_floor };
+
+// a floor scattered with count spheres and boxes, kept in a bounding volume hierarchy
+// and baked into a brick map
+auto crowd_field(size_t count = 512) {
+    PCG32 rng(42);
+    std::vector<Primitive> primitives;
+    for (size_t i = 0; i < count; i++) {
+        const float size = 0.2f + 0.3f * rng.next(1000) / 1000.0f;
+        const vec3 center(rng.next(4000) / 100.0f - 20.0f, size + rng.next(100) / 100.0f, rng.next(4000) / 100.0f + 3.0f);
+        primitives.push_back(i % 2 ? Primitive::sphere(center, size) : Primitive::box(center, vec3(size)));
+    }
+    return unite(material(crowd_floor, plane(vec3(0, 1, 0), 0)),
+        material(crowd_primitive, bake(vec3(-21, 0, 2), vec3(21, 3, 44), 0.05f, group(primitives))));
+}
+
+auto crowd_materials() {
+    return MaterialTable(
+        Flat{ vec3(0.5, 0.37, 0.1) },
+        Checkerboard{ vec3(1, 1, 1), vec3(0, 0, 0), 0.5f });
+}
+
+class CrowdScene final : public SdfScene<decltype(crowd_field()), decltype(crowd_materials())> {
+    public:
+    CrowdScene() : SdfScene(crowd_field(), crowd_materials()) {}
+};
+
+#endif
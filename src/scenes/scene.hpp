@@ -2,13 +2,22 @@
 #define SCENE_HPP
 
 #include "../linalg/vec.hpp"
+#include "../linalg/dual.hpp"
+#include "../linalg/interval.hpp"
 
 class Scene {
     public:
     virtual vec2 dist_field(const float t, const vec3& p) const = 0;
-    virtual vecpack<8, 2> dist_field_simd(const float t, const vecpack<8, 3>& p) const = 0;
+    virtual vecpack<simd_width, 2> dist_field_simd(const float t, const vecpack<simd_width, 3>& p) const = 0;
+    // distance along with its gradient, from a single evaluation on dual numbers
+    virtual dual<simd_width> dist_field_dual(const float t, const dualpack<simd_width, 3>& p) const = 0;
+    // bounds of the distance over the box p
+    virtual interval dist_field_interval(const float t, const intervalpack<3>& p) const = 0;
+    // the point the scene is seen from, scenes with levels of detail draw less of it farther away
+    virtual void set_viewpoint(const vec3& viewpoint) = 0;
     virtual vec3 texture(int texture_id, const vec3& pos) const = 0;
-    virtual vecpack<8, 3> texture_simd(const vec<8>& hit_time, const vec<8>& hit_texture) const = 0;
+    // the colors at the hit points of a pack, by material id
+    virtual vecpack<simd_width, 3> texture_simd(const vecpack<simd_width, 3>& pos, const vec<simd_width>& hit_texture) const = 0;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,70 @@
+#ifndef SDF_SCENE_HPP
+#define SDF_SCENE_HPP
+
+#include "../materials.hpp"
+#include "../sdf.hpp"
+#include "scene.hpp"
+
+// A scene whose distance fields all come from the one description of sdf.hpp, and
+// whose textures come from a table of materials indexed by the field's material ids.
+template<typename Field, typename Materials>
+class SdfScene : public Scene {
+    public:
+    SdfScene(const Field& field, const Materials& materials) : field(field), materials(materials) {}
+
+    vec2 dist_field(const float t, const vec3& p) const;
+    vecpack<simd_width, 2> dist_field_simd(const float t, const vecpack<simd_width, 3>& p) const;
+    dual<simd_width> dist_field_dual(const float t, const dualpack<simd_width, 3>& p) const;
+    interval dist_field_interval(const float t, const intervalpack<3>& p) const;
+    void set_viewpoint(const vec3& viewpoint);
+    vec3 texture(int texture_id, const vec3& pos) const;
+    vecpack<simd_width, 3> texture_simd(const vecpack<simd_width, 3>& pos, const vec<simd_width>& hit_texture) const;
+
+    protected:
+    // not const for the viewpoint of its levels of detail
+    Field field;
+    const Materials materials;
+};
+
+template<typename Field, typename Materials>
+vec2 SdfScene<Field, Materials>::dist_field(const float t, const vec3& p) const {
+    const auto d = field(t, p);
+    return vec2(distance_of(d), material_of(d));
+}
+
+template<typename Field, typename Materials>
+vecpack<simd_width, 2> SdfScene<Field, Materials>::dist_field_simd(const float t, const vecpack<simd_width, 3>& p) const {
+    const auto d = field(t, p);
+    vecpack<simd_width, 2> res;
+    res[0] = distance_of(d);
+    res[1] = material_of(d);
+
+    return res;
+}
+
+template<typename Field, typename Materials>
+dual<simd_width> SdfScene<Field, Materials>::dist_field_dual(const float t, const dualpack<simd_width, 3>& p) const {
+    return field(t, p);
+}
+
+template<typename Field, typename Materials>
+interval SdfScene<Field, Materials>::dist_field_interval(const float t, const intervalpack<3>& p) const {
+    return field(t, p);
+}
+
+template<typename Field, typename Materials>
+void SdfScene<Field, Materials>::set_viewpoint(const vec3& viewpoint) {
+    set_lod_viewpoint(field, viewpoint);
+}
+
+template<typename Field, typename Materials>
+vec3 SdfScene<Field, Materials>::texture(int texture_id, const vec3& pos) const {
+    return materials.color(texture_id, pos);
+}
+
+template<typename Field, typename Materials>
+vecpack<simd_width, 3> SdfScene<Field, Materials>::texture_simd(const vecpack<simd_width, 3>& pos, const vec<simd_width>& hit_texture) const {
+    return materials.color(hit_texture, pos);
+}
+
+#endif
@@ -3,41 +3,74 @@
 
 #include <SDL2/SDL.h>
 #include <array>
+#include <utility>
+#include <vector>
 
 #include "types.hpp"
 
-template<size_t screen_width, size_t screen_height>
+// A window showing a framebuffer. The framebuffer can be painted at a lower render
+// size than the window, only its top-left render_width x render_height pixels are
+// then presented, upscaled to the window.
 class Screen {
     public:
-    Screen();
+    // a double buffered screen draws into a back buffer while render() presents the front buffer,
+    // otherwise both are the same buffer and pixels show up as soon as they are drawn
+    Screen(size_t window_width, size_t window_height, bool double_buffered = false);
     ~Screen();
 
     bool initialize(const char* window_title);
     void put_pixel(const unsigned int x, const unsigned int y, const color& color);
 
+    // size of the back buffer's painted area, at most the window size.
+    // Like put_pixel, it must not race with swap_buffers.
+    void set_render_size(size_t width, size_t height);
+    size_t render_width() const;
+    size_t render_height() const;
+
+    // presents the back buffer on the next render(), must not race with put_pixel
+    void swap_buffers();
     void render();
     void sleep(unsigned int ms);
 
     private:
-    unsigned char& red(std::array<unsigned char, screen_width * screen_height * 4>& target, const unsigned int x, const unsigned int y);
-    unsigned char& green(std::array<unsigned char, screen_width * screen_height * 4>& target, const unsigned int x, const unsigned int y);
-    unsigned char& blue(std::array<unsigned char, screen_width * screen_height * 4>& target, const unsigned int x, const unsigned int y);
+    struct framebuffer {
+        std::vector<unsigned char> pixels;
+        size_t width, height;
+    };
+
+    unsigned char& red(framebuffer& target, const unsigned int x, const unsigned int y);
+    unsigned char& green(framebuffer& target, const unsigned int x, const unsigned int y);
+    unsigned char& blue(framebuffer& target, const unsigned int x, const unsigned int y);
 
     bool initialized;
-    
+    const size_t window_width, window_height;
+
     SDL_Window *window;
     SDL_Renderer *renderer;
     SDL_Texture *frame_texture;
 
-    std::array<unsigned char, screen_width * screen_height * 4> framebuffer {};
+    std::array<framebuffer, 2> framebuffers;
+    framebuffer* front;
+    framebuffer* back;
 };
 
-template<size_t screen_width, size_t screen_height>
-Screen<screen_width, screen_height>::Screen() {
+Screen::Screen(size_t window_width, size_t window_height, bool double_buffered) :
+    initialized(false), window_width(window_width), window_height(window_height) {
+    for (auto& buffer : framebuffers) {
+        buffer.width = window_width;
+        buffer.height = window_height;
+    }
+
+    framebuffers[0].pixels.resize(window_width * window_height * 4);
+    front = back = &framebuffers[0];
+
+    if (double_buffered) {
+        framebuffers[1].pixels.resize(window_width * window_height * 4);
+        back = &framebuffers[1];
+    }
 }
 
-template<size_t screen_width, size_t screen_height>
-Screen<screen_width, screen_height>::~Screen() {
+Screen::~Screen() {
     if (this->initialized) {
         SDL_DestroyTexture(this->frame_texture);
         SDL_DestroyWindow(this->window);
@@ -46,8 +79,7 @@ Screen<screen_width, screen_height>::~Screen() {
     }
 }
 
-template<size_t screen_width, size_t screen_height>
-bool Screen<screen_width, screen_height>::initialize(const char* window_title) {
+bool Screen::initialize(const char* window_title) {
     if (SDL_Init(SDL_INIT_VIDEO ) < 0) {
         printf( "Failed to initialize SDL, SDL_Error: %s\n", SDL_GetError());
         return false;
@@ -55,50 +87,68 @@ bool Screen<screen_width, screen_height>::initialize(const char* window_title) {
 
     this->window = SDL_CreateWindow(window_title,
         SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
-        screen_width, screen_height,
+        window_width, window_height,
         SDL_WINDOW_SHOWN);
 
     this->renderer = SDL_CreateRenderer(this->window, -1, SDL_RENDERER_ACCELERATED);
-    this->frame_texture = SDL_CreateTexture(this->renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, screen_width, screen_height);
+    this->frame_texture = SDL_CreateTexture(this->renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, window_width, window_height);
 
     return this->initialized = true;
 }
 
-template<size_t screen_width, size_t screen_height>
-inline void Screen<screen_width, screen_height>::put_pixel(const unsigned int x, const unsigned int y, const color& color) {
-    this->red(this->framebuffer, x, y) = std::get<0>(color);
-    this->green(this->framebuffer, x, y) = std::get<1>(color);
-    this->blue(this->framebuffer, x, y) = std::get<2>(color);
+inline void Screen::put_pixel(const unsigned int x, const unsigned int y, const color& color) {
+    this->red(*this->back, x, y) = std::get<0>(color);
+    this->green(*this->back, x, y) = std::get<1>(color);
+    this->blue(*this->back, x, y) = std::get<2>(color);
 }
 
-template<size_t screen_width, size_t screen_height>
-inline unsigned char& Screen<screen_width, screen_height>::red(std::array<unsigned char, screen_width * screen_height * 4>& target, const unsigned int x, const unsigned int y) {
-    const unsigned int offset = (screen_width * 4 * y) + x * 4;
-    return target[offset+2];
+void Screen::set_render_size(size_t width, size_t height) {
+    this->back->width = std::min(width, window_width);
+    this->back->height = std::min(height, window_height);
 }
 
-template<size_t screen_width, size_t screen_height>
-inline unsigned char& Screen<screen_width, screen_height>::green(std::array<unsigned char, screen_width * screen_height * 4>& target, const unsigned int x, const unsigned int y) {
-    const unsigned int offset = (screen_width * 4 * y) + x * 4;
-    return target[offset+1];
+inline size_t Screen::render_width() const {
+    return this->back->width;
 }
 
-template<size_t screen_width, size_t screen_height>
-inline unsigned char& Screen<screen_width, screen_height>::blue(std::array<unsigned char, screen_width * screen_height * 4>& target, const unsigned int x, const unsigned int y) {
-    const unsigned int offset = (screen_width * 4 * y) + x * 4;
-    return target[offset];
+inline size_t Screen::render_height() const {
+    return this->back->height;
 }
 
-template<size_t screen_width, size_t screen_height>
-void Screen<screen_width, screen_height>::render() {
-    SDL_UpdateTexture (this->frame_texture, NULL, this->framebuffer.data(), screen_width * 4);
-    SDL_RenderCopy(this->renderer, this->frame_texture, NULL, NULL);
+void Screen::swap_buffers() {
+    if (this->front == this->back) return;
+
+    // the new back buffer keeps painting at the current render size
+    this->front->width = this->back->width;
+    this->front->height = this->back->height;
+    std::swap(this->front, this->back);
+}
+
+inline unsigned char& Screen::red(framebuffer& target, const unsigned int x, const unsigned int y) {
+    const unsigned int offset = (window_width * 4 * y) + x * 4;
+    return target.pixels[offset+2];
+}
+
+inline unsigned char& Screen::green(framebuffer& target, const unsigned int x, const unsigned int y) {
+    const unsigned int offset = (window_width * 4 * y) + x * 4;
+    return target.pixels[offset+1];
+}
+
+inline unsigned char& Screen::blue(framebuffer& target, const unsigned int x, const unsigned int y) {
+    const unsigned int offset = (window_width * 4 * y) + x * 4;
+    return target.pixels[offset];
+}
+
+void Screen::render() {
+    const SDL_Rect painted = { 0, 0, (int)this->front->width, (int)this->front->height };
+
+    SDL_UpdateTexture (this->frame_texture, &painted, this->front->pixels.data(), window_width * 4);
+    SDL_RenderCopy(this->renderer, this->frame_texture, &painted, NULL);
     SDL_RenderPresent(this->renderer);
 }
 
-template<size_t screen_width, size_t screen_height>
-void Screen<screen_width, screen_height>::sleep(unsigned int ms) {
+void Screen::sleep(unsigned int ms) {
     SDL_Delay(ms);
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,494 @@
+#ifndef SDF_HPP
+#define SDF_HPP
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+#include "linalg/vec.hpp"
+#include "linalg/vecpack.hpp"
+#include "linalg/dual.hpp"
+#include "distances.hpp"
+#include "transformations.hpp"
+
+// Distance fields described by a tree of types. Every node is evaluated at a time t and a
+// point, which may be a vec3, a vecpack of points, a dualpack or the intervalpack of a box,
+// so that a scene written once gives the scalar, the simd and the dual distance fields, and
+// bounds of the distances over boxes. The tree is known at compile time and each of these is
+// inlined into a single function.
+//
+//   auto field = smooth_unite(0.32f, plane(vec3(0, 1, 0), 0), translate(vec3(0, 1, 3), sphere(0.5f)));
+//   field(t, p);
+
+struct Sphere {
+    float r;
+
+    template<typename point>
+    auto operator()(const float t, const point& p) const {
+        return dist_sphere(r, p);
+    }
+};
+
+struct Plane {
+    vec3 n;
+    float h;
+
+    template<typename point>
+    auto operator()(const float t, const point& p) const {
+        return dist_plane(n, h, p);
+    }
+};
+
+struct Box {
+    vec3 b;
+
+    template<typename point>
+    auto operator()(const float t, const point& p) const {
+        return dist_box(b, p);
+    }
+};
+
+// the child moved by offset, either a vec3 or a function of the time returning one
+template<typename Offset, typename Child>
+struct Translate {
+    Offset offset;
+    Child child;
+
+    template<typename point>
+    auto operator()(const float t, const point& p) const {
+        if constexpr (std::is_invocable_v<Offset, float>) {
+            const point q = p - vec3(offset(t));
+            return child(t, q);
+        } else {
+            const point q = p - offset;
+            return child(t, q);
+        }
+    }
+};
+
+// an offset swinging around center, for translations animated with the time
+struct Oscillate {
+    vec3 center, amplitude;
+
+    vec3 operator()(const float t) const {
+        return center + sin(t) * amplitude;
+    }
+};
+
+template<typename Child>
+struct RepeatX {
+    float pattern;
+    Child child;
+
+    template<typename point>
+    auto operator()(const float t, const point& p) const {
+        return child(t, repeatX(pattern, p));
+    }
+};
+
+// the child repeated every period along the axes whose period is not 0, over the cells -limit
+// to limit. The child is taken to fit in its cell unless neighbours is set, in which case the
+// neighbouring cell on the side of the point is evaluated too along each axis, i.e. up to 8 cells.
+template<typename Child>
+struct Repeat {
+    vec3 period, limit;
+    bool neighbours;
+    Child child;
+
+    template<typename point>
+    auto operator()(const float t, const point& p) const;
+};
+
+template<typename Child>
+template<typename point>
+auto Repeat<Child>::operator()(const float t, const point& p) const {
+    using std::clamp;
+    using std::min;
+    using cell = decltype(cellIndex(p[0], 1.0f));
+
+    std::array<cell, 3> index;
+    for (size_t k = 0; k < 3; k++) {
+        index[k] = period[k] != 0.0f ? clamp(cellIndex(p[k], period[k]), -limit[k], limit[k]) : cell(0.0f);
+    }
+
+    auto d = child(t, toCell(period, index, p));
+    if (!neighbours) return d;
+
+    // the same cell again when at the limit
+    std::array<cell, 3> neighbour = index;
+    for (size_t k = 0; k < 3; k++) {
+        if (period[k] != 0.0f) neighbour[k] = clamp(neighbourCell(p[k], period[k], index[k]), -limit[k], limit[k]);
+    }
+
+    const unsigned axes = (period[0] != 0.0f) | (period[1] != 0.0f) << 1 | (period[2] != 0.0f) << 2;
+    for (unsigned cells = 1; cells < 8; cells++) {
+        if ((cells & axes) != cells) continue;
+
+        std::array<cell, 3> other = index;
+        for (size_t k = 0; k < 3; k++) {
+            if (cells & (1u << k)) other[k] = neighbour[k];
+        }
+        d = min(d, child(t, toCell(period, other, p)));
+    }
+    return d;
+}
+
+template<typename Child>
+struct Mirror {
+    unsigned axes;
+    Child child;
+
+    template<typename point>
+    auto operator()(const float t, const point& p) const {
+        return child(t, symAxes(axes, p));
+    }
+};
+
+// the child, around the x axis, repeated count times around the y axis
+template<typename Child>
+struct PolarRepeat {
+    float count;
+    Child child;
+
+    template<typename point>
+    auto operator()(const float t, const point& p) const {
+        return child(t, repeatPolar(count, p));
+    }
+};
+
+// the child's surface roughened by amount times displacement(p). The distance is scaled down
+// by the steepest slope of the displacement, so that it stays a bound for the march, and kept
+// within amount of the child's, which bounds it as well since the surfaces are that close.
+template<typename Child>
+struct Displace {
+    float amount;
+    Child child;
+
+    template<typename point>
+    auto operator()(const float t, const point& p) const {
+        using std::max;
+        using std::min;
+        const auto d = child(t, p);
+        const auto displaced = (d + amount * displacement(p)) * (1.0f / (1.0f + amount * displacement_slope));
+        return max(min(displaced, d + amount), d - amount);
+    }
+};
+
+template<typename Lhs, typename Rhs>
+struct Unite {
+    Lhs lhs;
+    Rhs rhs;
+
+    template<typename point>
+    auto operator()(const float t, const point& p) const {
+        // the block scope declaration hides the scalar min of the namespace, the others are found by ADL
+        using std::min;
+        return min(lhs(t, p), rhs(t, p));
+    }
+};
+
+template<typename Lhs, typename Rhs>
+struct SmoothUnite {
+    float k;
+    Lhs lhs;
+    Rhs rhs;
+
+    template<typename point>
+    auto operator()(const float t, const point& p) const {
+        return smin(lhs(t, p), rhs(t, p), k);
+    }
+};
+
+template<typename Lhs, typename Rhs>
+struct Intersect {
+    Lhs lhs;
+    Rhs rhs;
+
+    template<typename point>
+    auto operator()(const float t, const point& p) const {
+        using std::max;
+        return max(lhs(t, p), rhs(t, p));
+    }
+};
+
+// lhs with rhs carved out of it
+template<typename Lhs, typename Rhs>
+struct Subtract {
+    Lhs lhs;
+    Rhs rhs;
+
+    template<typename point>
+    auto operator()(const float t, const point& p) const {
+        using std::max;
+        return max(lhs(t, p), -rhs(t, p));
+    }
+};
+
+// A distance along with the id of the material of the surface it is to, as returned by the
+// nodes below a material node. Combinations keep the material of the side the distance comes from.
+template<typename D>
+struct Surface {
+    D distance;
+    D material;
+};
+
+// gives its child's surface the material id. Normals and bounds need no material, on dual points
+// and boxes the child's distance is returned as is.
+template<typename Child>
+struct Material {
+    float id;
+    Child child;
+
+    template<typename point>
+    auto operator()(const float t, const point& p) const {
+        const auto d = child(t, p);
+        return Surface<std::decay_t<decltype(d)>>{ d, id };
+    }
+
+    template<size_t N>
+    auto operator()(const float t, const dualpack<N, 3>& p) const {
+        return child(t, p);
+    }
+
+    interval operator()(const float t, const intervalpack<3>& p) const {
+        return child(t, p);
+    }
+};
+
+Surface<float> min(const Surface<float>& lhs, const Surface<float>& rhs) {
+    return lhs.distance < rhs.distance ? lhs : rhs;
+}
+
+template<size_t N>
+Surface<vec<N>> min(const Surface<vec<N>>& lhs, const Surface<vec<N>>& rhs) {
+    const vmask<N> m = lhs.distance < rhs.distance;
+    return { select(m, lhs.distance, rhs.distance), select(m, lhs.material, rhs.material) };
+}
+
+Surface<float> max(const Surface<float>& lhs, const Surface<float>& rhs) {
+    return lhs.distance > rhs.distance ? lhs : rhs;
+}
+
+template<size_t N>
+Surface<vec<N>> max(const Surface<vec<N>>& lhs, const Surface<vec<N>>& rhs) {
+    const vmask<N> m = lhs.distance > rhs.distance;
+    return { select(m, lhs.distance, rhs.distance), select(m, lhs.material, rhs.material) };
+}
+
+template<typename D>
+Surface<D> smin(const Surface<D>& lhs, const Surface<D>& rhs, float k) {
+    return { smin(lhs.distance, rhs.distance, k), min(lhs, rhs).material };
+}
+
+template<typename D>
+Surface<D> operator-(const Surface<D>& v) {
+    return { -v.distance, v.material };
+}
+
+template<typename D, typename S>
+Surface<D> operator*(const Surface<D>& v, const S& s) {
+    return { v.distance * s, v.material };
+}
+
+// the distance and material id of whatever a field returns, material 0 without material nodes
+template<typename D>
+const D& distance_of(const Surface<D>& d) { return d.distance; }
+
+template<typename D>
+const D& material_of(const Surface<D>& d) { return d.material; }
+
+template<typename D>
+const D& distance_of(const D& d) { return d; }
+
+template<typename D>
+D material_of(const D& d) { return D(0.0f); }
+
+// whether the distances of two levels are within max_difference of each other
+bool lod_within(float near, float far, float max_difference) {
+    return std::abs(far - near) <= max_difference;
+}
+
+template<size_t N>
+bool lod_within(const vec<N>& near, const vec<N>& far, float max_difference) {
+    return all(abs(far - near) <= max_difference);
+}
+
+template<size_t N>
+bool lod_within(const dual<N>& near, const dual<N>& far, float max_difference) {
+    return lod_within(near.value, far.value, max_difference);
+}
+
+template<typename D>
+bool lod_within(const Surface<D>& near, const Surface<D>& far, float max_difference) {
+    return lod_within(near.distance, far.distance, max_difference);
+}
+
+// the factor keeping a level's distance d a bound gap away from the blend, gap being negative
+// within it: 1 when d reaches no further than the blend, scale within it, and down to it in between
+float lod_factor(float d, float gap, float scale) {
+    return d <= std::max(gap, 0.0f) ? 1.0f : std::max(gap / d, scale);
+}
+
+template<size_t N>
+vec<N> lod_factor(const vec<N>& d, const vec<N>& gap, float scale) {
+    return select(d <= max(gap, 0.0f), vec<N>(1.0f), max(gap / d, scale));
+}
+
+// near moved by weight w towards far, the material is the one of the closest level
+template<typename D, typename W>
+D lod_blend(const D& near, const D& far, const W& w) {
+    return near + w * (far - near);
+}
+
+Surface<float> lod_blend(const Surface<float>& near, const Surface<float>& far, float w) {
+    return { lod_blend(near.distance, far.distance, w), w < 0.5f ? near.material : far.material };
+}
+
+template<size_t N>
+Surface<vec<N>> lod_blend(const Surface<vec<N>>& near, const Surface<vec<N>>& far, const vec<N>& w) {
+    return { lod_blend(near.distance, far.distance, w), select(w < 0.5f, near.material, far.material) };
+}
+
+// Two levels of detail of a scene: near is drawn up to near_distance from the viewpoint, far
+// beyond far_distance, typically without small details, or as cheaper bounding shapes. They are
+// blended in between so that surfaces morph rather than pop. The level is chosen per point,
+// i.e. per lane of a pack: for the rays from the viewpoint, from their current distance.
+// Normals and shadows of a surface see the level its rays saw.
+//
+// The weight of the blend changes by 1 / (far_distance - near_distance) per unit, so the blend
+// of two distance bounds differing by at most max_difference is not steeper than 1 + their
+// difference over that width. The field is scaled down by that much to stay a bound within the
+// blend, and outside of it where a step could reach it, see lod_factor. Far must be within
+// max_difference of near wherever they are blended, which debug builds assert.
+//
+// Only a Lod node at the root of a scene's field follows its camera, see SdfScene: the viewpoint
+// of one anywhere else stays at the origin.
+template<typename Near, typename Far>
+struct Lod {
+    vec3 viewpoint;
+    float near_distance, far_distance, max_difference;
+    Near near;
+    Far far;
+
+    template<typename point>
+    auto weight(const point& p) const {
+        using std::clamp;
+        return clamp((len(p - viewpoint) - near_distance) * (1.0f / (far_distance - near_distance)), 0.0f, 1.0f);
+    }
+
+    float scale() const {
+        return 1.0f / (1.0f + max_difference / (far_distance - near_distance));
+    }
+
+    // the value of a level or of the blend at p, made a bound
+    template<typename D, typename point>
+    D bounded(const D& d, const point& p) const {
+        using std::max;
+        const auto r = len(value_of(p) - viewpoint);
+        return d * lod_factor(value_of(distance_of(d)), max(near_distance - r, r - far_distance), scale());
+    }
+
+    template<typename D, typename W>
+    D blend(const D& n, const D& f, const W& w) const {
+        // with some slack for the rounding of the distances
+        assert(lod_within(n, f, 1.01f * max_difference + 1e-5f));
+        return lod_blend(n, f, w);
+    }
+
+    auto operator()(const float t, const vec3& p) const {
+        const float w = weight(p);
+        if (w <= 0.0f) return bounded(near(t, p), p);
+        if (w >= 1.0f) return bounded(far(t, p), p);
+        return bounded(blend(near(t, p), far(t, p), w), p);
+    }
+
+    template<size_t N>
+    auto operator()(const float t, const vecpack<N, 3>& p) const {
+        const vec<N> w = weight(p);
+        if (all(w <= 0.0f)) return bounded(near(t, p), p);
+        if (all(w >= 1.0f)) return bounded(far(t, p), p);
+        return bounded(blend(near(t, p), far(t, p), w), p);
+    }
+
+    template<size_t N>
+    auto operator()(const float t, const dualpack<N, 3>& p) const {
+        const dual<N> w = weight(p);
+        if (all(w.value <= 0.0f)) return bounded(near(t, p), p);
+        if (all(w.value >= 1.0f)) return bounded(far(t, p), p);
+        return bounded(blend(near(t, p), far(t, p), w), p);
+    }
+
+    // the blends lie between both levels, the factors between scale and 1
+    interval operator()(const float t, const intervalpack<3>& p) const {
+        const interval n = near(t, p), f = far(t, p);
+        const interval d(std::min(n.lo, f.lo), std::max(n.hi, f.hi));
+        return interval(std::min(d.lo, d.lo * scale()), std::max(d.hi, d.hi * scale()));
+    }
+};
+
+// moves the viewpoint of a field with a Lod node at its root, other fields have none
+template<typename Field>
+void set_lod_viewpoint(Field& field, const vec3& viewpoint) {}
+
+template<typename Near, typename Far>
+void set_lod_viewpoint(Lod<Near, Far>& field, const vec3& viewpoint) { field.viewpoint = viewpoint; }
+
+Sphere sphere(float r) { return { r }; }
+
+Plane plane(const vec3& n, float h) { return { n, h }; }
+
+Box box(const vec3& b) { return { b }; }
+
+template<typename Offset, typename Child>
+Translate<Offset, Child> translate(const Offset& offset, const Child& child) { return { offset, child }; }
+
+template<typename Child>
+RepeatX<Child> repeat_x(float pattern, const Child& child) { return { pattern, child }; }
+
+template<typename Child>
+Repeat<Child> repeat(const vec3& period, const Child& child) {
+    return { period, vec3(std::numeric_limits<float>::infinity()), false, child };
+}
+
+template<typename Child>
+Repeat<Child> repeat_neighbours(const vec3& period, const Child& child) {
+    return { period, vec3(std::numeric_limits<float>::infinity()), true, child };
+}
+
+template<typename Child>
+Repeat<Child> repeat_bounded(const vec3& period, const vec3& limit, const Child& child) { return { period, limit, true, child }; }
+
+template<typename Child>
+Mirror<Child> mirror(unsigned axes, const Child& child) { return { axes, child }; }
+
+template<typename Child>
+PolarRepeat<Child> polar_repeat(float count, const Child& child) { return { count, child }; }
+
+template<typename Child>
+Displace<Child> displace(float amount, const Child& child) { return { amount, child }; }
+
+template<typename Lhs, typename Rhs>
+Unite<Lhs, Rhs> unite(const Lhs& lhs, const Rhs& rhs) { return { lhs, rhs }; }
+
+template<typename Lhs, typename Rhs>
+SmoothUnite<Lhs, Rhs> smooth_unite(float k, const Lhs& lhs, const Rhs& rhs) { return { k, lhs, rhs }; }
+
+template<typename Lhs, typename Rhs>
+Intersect<Lhs, Rhs> intersect(const Lhs& lhs, const Rhs& rhs) { return { lhs, rhs }; }
+
+template<typename Lhs, typename Rhs>
+Subtract<Lhs, Rhs> subtract(const Lhs& lhs, const Rhs& rhs) { return { lhs, rhs }; }
+
+template<typename Child>
+Material<Child> material(float id, const Child& child) { return { id, child }; }
+
+// must be the root of a scene's field for its viewpoint to follow the camera, see Lod
+template<typename Near, typename Far>
+Lod<Near, Far> lod(float near_distance, float far_distance, float max_difference, const Near& near, const Far& far) {
+    return { vec3(0.0f), near_distance, far_distance, max_difference, near, far };
+}
+
+#endif
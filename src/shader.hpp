@@ -15,6 +15,11 @@ struct ShaderConfig {
     float max_dist;
     int max_its;
 
+    // Rays and shadow rays step by relaxation times the distance bound, 1 for plain sphere tracing.
+    // An over-relaxed step is taken back as soon as the spheres at both of its ends stop overlapping,
+    // the ray then goes on with plain steps. Values around 1.2 to 1.6 cut the number of steps.
+    float relaxation;
+
     vec3 light_dir;
     vec3 background_color;
 
@@ -22,70 +27,129 @@ struct ShaderConfig {
     float time;
 };
 
+// The shader is compiled for the type of its scene: with a final scene class, the distance
+// fields are called directly and the march loops are inlined and specialised for the scene.
+// Shader<Scene> goes through the virtual functions instead and renders any scene.
+template<typename SceneType = Scene>
 class Shader {
     public:
-    Shader(const ShaderConfig* config, const Camera* camera, const Scene* scene) : config(config), camera(camera), scene(scene) {}
+    Shader(const ShaderConfig* config, const Camera* camera, const SceneType* scene) : config(config), camera(camera), scene(scene) {}
     color render_pixel(const size_t x, const size_t y) const;
-    std::array<color, 8> render_pixel_simd(const vecpack<8, 2>& pixels) const;
+    std::array<color, simd_width> render_pixel_simd(const vecpack<simd_width, 2>& pixels) const;
+    // rays start marching at start instead of the near plane, hit_time receives their hit distance.
+    // start may be a guess, rays starting inside a surface march again from safe_start.
+    std::array<color, simd_width> render_pixel_simd(const vecpack<simd_width, 2>& pixels, const vec<simd_width>& start, vec<simd_width>& hit_time, float safe_start = 1.0f) const;
+
+    // Marches simd_width cones, each containing the rays through the pixels within radius of its center,
+    // from start to where the cone first touches a surface. No ray of a cone can hit anything
+    // closer than the returned distance, which is capped to max_dist when the cone escapes.
+    vec<simd_width> cone_march_simd(const vecpack<simd_width, 2>& centers, const vec<simd_width>& radius, const vec<simd_width>& start) const;
+
+    // Bounds the distance field over boxes holding the rays through the pixels within radius of center,
+    // one range of distances along the rays after the other from start on, the last one reaching max_dist.
+    // Returns the distance up to which these ranges are proven empty, max_dist when they all are,
+    // i.e. when the rays see only sky.
+    float interval_march(const vec2& center, float radius, float start) const;
+
+    // rays starting at or past max_dist see only sky
+    bool escaped(float start) const {
+        return start >= config->max_dist;
+    }
+
+    // Marches the rays of num_packs packs of pixels as one stream through simd_width lanes: a lane whose ray
+    // is done takes the next ray of the stream, rather than idling until its whole pack is done.
+    // Starts are as for render_pixel_simd, the results are written per pack.
+    template<size_t max_packs>
+    void march_stream_simd(size_t num_packs, const std::array<vecpack<simd_width, 2>, max_packs>& pixels,
+                           const std::array<vec<simd_width>, max_packs>& start, const std::array<float, max_packs>& safe_start,
+                           std::array<vec<simd_width>, max_packs>& hit_time, std::array<vec<simd_width>, max_packs>& hit_texture) const;
+
+    // colors of simd_width pixels from the hits of their rays
+    std::array<color, simd_width> shade_pixel_simd(const vecpack<simd_width, 2>& pixels, const vec<simd_width>& hit_time, const vec<simd_width>& hit_texture) const;
 
     private:
     vec2 march(const float t, const vec3& direction) const;
-    vecpack<8, 2> march_simd(const float t, const vecpack<8, 3>& directions) const;
+    vecpack<simd_width, 2> march_simd(const float t, const vecpack<simd_width, 3>& directions, const vec<simd_width>& start, float safe_start) const;
 
     vec3 normal(const float t, const vec3& p) const;
-    vecpack<8, 3> normal_simd(const float t, const vecpack<8, 3>& p) const;
+    // analytic normal, the distance field being evaluated once on dual numbers
+    vecpack<simd_width, 3> normal_simd(const float t, const vecpack<simd_width, 3>& p) const;
 
     float ambient(const vec3& p, const vec3& n) const;
-    vec<8> ambient_simd(const vecpack<8, 3>& p, const vecpack<8, 3>& n) const;
+    vec<simd_width> ambient_simd(const vecpack<simd_width, 3>& p, const vecpack<simd_width, 3>& n) const;
 
     float shadow(const float t, const vec3& p, int k) const;
-    vec<8> shadow_simd(const float t, const vecpack<8, 3>& p, int k) const;
+    // the shadow rays of the lanes out of active are not marched, their result is 0
+    vec<simd_width> shadow_simd(const float t, const vecpack<simd_width, 3>& p, int k, const vmask<simd_width>& active) const;
 
     vec3 apply_fog(const vec3& original_color, float distance, const vec3& ray_dir, const vec3& sun_dir) const;
-    vecpack<8, 3> apply_fog_simd(const vecpack<8, 3>& original_color, vec<8> distance, const vecpack<8, 3>& ray_dir, const vecpack<8, 3>& sun_dir) const;
+    vecpack<simd_width, 3> apply_fog_simd(const vecpack<simd_width, 3>& original_color, vec<simd_width> distance, const vecpack<simd_width, 3>& ray_dir, const vecpack<simd_width, 3>& sun_dir) const;
+
+    static constexpr int max_interval_its = 4;
+    // relative to the distance
+    static constexpr float min_interval_length = 0.25f;
 
     const ShaderConfig* config;
     const Camera* camera;
-    const Scene* scene;
+    const SceneType* scene;
 };
 
-std::array<color, 8> Shader::render_pixel_simd(const vecpack<8, 2>& pixels) const {
-    vecpack<8, 3> dir = camera->get_ray_dir_simd(pixels);
-    std::array<color, 8> colors;
-
-    vecpack<8, 2> res = march_simd(config->time, dir);
-    vec<8> hit_time = res[0];
-    vec<8> hit_texture = res[1];
-    vec<8> col_mask = hit_time >= 0;
-    vecpack<8, 3> fcolors = scene->texture_simd(hit_time, hit_texture);
-
-    vecpack<8, 3> p = camera->position + hit_time * dir;
-    vecpack<8, 3> n = normal_simd(config->time, p);
-
-    vec<8> sun = ambient_simd(p, n);
-    vec<8> sha = shadow_simd(config->time, p + 0.1f * n, 32);
-    vec<8> sky = clamp(0.5f + 0.5f*n[1], 0.0f, 1.0f);
+template<typename SceneType>
+std::array<color, simd_width> Shader<SceneType>::render_pixel_simd(const vecpack<simd_width, 2>& pixels) const {
+    vec<simd_width> hit_time;
+    return render_pixel_simd(pixels, 1.0f, hit_time);
+}
 
-    vec<3> l = normalize(config->light_dir * vec3(-1.0,0.0,-1.0));
-    vec<8> ind = clamp(dot(n, l), 0.0f, 1.0f);
+template<typename SceneType>
+std::array<color, simd_width> Shader<SceneType>::render_pixel_simd(const vecpack<simd_width, 2>& pixels, const vec<simd_width>& start, vec<simd_width>& hit_time, float safe_start) const {
+    vecpack<simd_width, 2> res = march_simd(config->time, camera->get_ray_dir_simd(pixels), start, safe_start);
+    hit_time = res[0];
+    return shade_pixel_simd(pixels, res[0], res[1]);
+}
 
-    vecpack<8, 3> lin(vec3(0.0f, 0.0f, 0.0f));
-    lin = lin + sun * vec3(1.64,1.27,0.99)/2.0f * pow(sha,vec3(1.0,1.2,1.5));
-    lin = lin + sky * vec3(0.16,0.20,0.28);
-    lin = lin + ind * vec3(0.40,0.28,0.20);
+template<typename SceneType>
+std::array<color, simd_width> Shader<SceneType>::shade_pixel_simd(const vecpack<simd_width, 2>& pixels, const vec<simd_width>& hit_time, const vec<simd_width>& hit_texture) const {
+    vecpack<simd_width, 3> dir = camera->get_ray_dir_simd(pixels);
+    std::array<color, simd_width> colors;
+
+    vmask<simd_width> hit = hit_time >= 0.0f;
+    vecpack<simd_width, 3> fcolors(config->background_color);
+
+    // packs of sky skip the lighting
+    if (any(hit)) {
+        vecpack<simd_width, 3> p = camera->position + hit_time * dir;
+        fcolors = scene->texture_simd(p, hit_texture);
+        vecpack<simd_width, 3> n = normal_simd(config->time, p);
+
+        // the shadow only darkens the sun term, the lanes it misses, facing away from the
+        // light, skip their shadow rays along with the sky, and so do whole packs of them
+        vec<simd_width> sun = ambient_simd(p, n);
+        vmask<simd_width> lit = hit & (sun > 0.0f);
+        vec<simd_width> sha(0.0f);
+        if (any(lit)) sha = shadow_simd(config->time, p + 0.1f * n, 32, lit);
+        vec<simd_width> sky = clamp(0.5f + 0.5f*n[1], 0.0f, 1.0f);
+
+        vec<3> l = normalize(config->light_dir * vec3(-1.0,0.0,-1.0));
+        vec<simd_width> ind = clamp(dot(n, l), 0.0f, 1.0f);
+
+        vecpack<simd_width, 3> lin(vec3(0.0f, 0.0f, 0.0f));
+        lin = lin + sun * vec3(1.64,1.27,0.99)/2.0f * pow(sha,vec3(1.0,1.2,1.5));
+        lin = lin + sky * vec3(0.16,0.20,0.28);
+        lin = lin + ind * vec3(0.40,0.28,0.20);
 
-    fcolors = lin * fcolors;
-    fcolors = col_mask * fcolors + (1.0f - col_mask) * config->background_color;
+        fcolors = lin * fcolors;
+        fcolors = select(hit, fcolors, vecpack<simd_width, 3>(config->background_color));
+    }
 
     fcolors = apply_fog_simd(fcolors, hit_time, dir, config->light_dir);
 
     fcolors = 255.0f * fcolors;
 
-    std::array<float, 8> r = fcolors[0],
+    std::array<float, simd_width> r = fcolors[0],
                          g = fcolors[1],
                          b = fcolors[2];
 
-    for (auto i = 0; i < 8; i++) {
+    for (size_t i = 0; i < simd_width; i++) {
         colors[i] = std::make_tuple(
             (unsigned char)(int)r[i],
             (unsigned char)(int)g[i],
@@ -95,7 +159,8 @@ std::array<color, 8> Shader::render_pixel_simd(const vecpack<8, 2>& pixels) cons
     return colors;
 }
 
-color Shader::render_pixel(const size_t x, const size_t y) const {
+template<typename SceneType>
+color Shader<SceneType>::render_pixel(const size_t x, const size_t y) const {
     vec3 dir = camera->get_ray_dir(vec2(x, y));
     vec3 color;
     vec2 res = march(config->time, dir);
@@ -135,7 +200,8 @@ color Shader::render_pixel(const size_t x, const size_t y) const {
     );
 }
 
-vec3 Shader::normal(const float t, const vec3& p) const {
+template<typename SceneType>
+vec3 Shader<SceneType>::normal(const float t, const vec3& p) const {
     float d = 0.5773*0.0001;
     vec3 d1(d,-d,-d);
     vec3 d2(-d,-d,d);
@@ -146,46 +212,69 @@ vec3 Shader::normal(const float t, const vec3& p) const {
                      d3*scene->dist_field(t, p+d3)[0] + d4*scene->dist_field(t, p+d4)[0]);
 }
 
-vecpack<8, 3> Shader::normal_simd(const float t, const vecpack<8, 3>& p) const {
-    float d = 0.5773*0.0001;
-    vecpack<8, 3> d1 = vecpack3<8>(d,-d,-d);
-    vecpack<8, 3> d2 = vecpack3<8>(-d,-d,d);
-    vecpack<8, 3> d3 = vecpack3<8>(-d,d,-d);
-    vecpack<8, 3> d4 = vecpack3<8>(d,d,d);
-
-    return normalize(d1*scene->dist_field_simd(t, p+d1)[0] + d2*scene->dist_field_simd(t, p+d2)[0] + 
-                     d3*scene->dist_field_simd(t, p+d3)[0] + d4*scene->dist_field_simd(t, p+d4)[0]);
+template<typename SceneType>
+vecpack<simd_width, 3> Shader<SceneType>::normal_simd(const float t, const vecpack<simd_width, 3>& p) const {
+    return normalize(scene->dist_field_dual(t, dual_point(p)).gradient);
 }
 
-float Shader::ambient(const vec3& p, const vec3& n) const {
+template<typename SceneType>
+float Shader<SceneType>::ambient(const vec3& p, const vec3& n) const {
     return std::clamp(dot(n, config->light_dir), 0.0f, 1.0f);
 }
 
-vec<8> Shader::ambient_simd(const vecpack<8, 3>& p, const vecpack<8, 3>& n) const {
-    vec<8> dots = dot(n, config->light_dir);
+template<typename SceneType>
+vec<simd_width> Shader<SceneType>::ambient_simd(const vecpack<simd_width, 3>& p, const vecpack<simd_width, 3>& n) const {
+    vec<simd_width> dots = dot(n, config->light_dir);
     return clamp(dots, 0.0f, 1.0f);
 }
 
-vec2 Shader::march(const float gt, const vec3& direction) const {
+template<typename SceneType>
+vec2 Shader<SceneType>::march(const float gt, const vec3& direction) const {
     vec2 res(config->max_dist, 0);
     float t = 1.0;
+    float omega = config->relaxation, step = 0.0f, previous = 0.0f;
 
     for (int s = 0; s < config->max_its && t < config->max_dist; s++) {
         res = scene->dist_field(gt, camera->position + t * direction);
+
+        // the relaxed step may have skipped over a surface, it is replaced by the plain one
+        if (omega > 1.0f && res[0] + previous < step) {
+            t += previous - step;
+            omega = 1.0f;
+            continue;
+        }
+
         if (res[0] < 0.0005*t) {
             return vec2(t, res[1]);
         }
-        t += res[0];
+
+        previous = res[0];
+        step = omega * res[0];
+        t += step;
     }
 
     return vec2(-1, 0);
 }
 
-vecpack<8, 2> Shader::march_simd(const float gt, const vecpack<8, 3>& directions) const {
-    vecpack<8, 2> res;
-    vecpack<8, 3> cam(camera->position), tpack;
+template<typename SceneType>
+vecpack<simd_width, 2> Shader<SceneType>::march_simd(const float gt, const vecpack<simd_width, 3>& directions, const vec<simd_width>& start, float safe_start) const {
+    vecpack<simd_width, 2> res;
+    vecpack<simd_width, 3> cam(camera->position), tpack;
+
+    vec<simd_width> distance, texture, t(start);
+    vec<simd_width> omega(config->relaxation), step(0.0f), previous(0.0f);
+    vmask<simd_width> hit, escaped, active, failed, collided;
+
+    // a start guessed past the surface puts the ray inside of it, those rays march from the safe start
+    vmask<simd_width> guessed = start > safe_start;
+    if (any(guessed)) {
+        tpack = t;
+        vmask<simd_width> inside = guessed & (scene->dist_field_simd(gt, mul_add(tpack, directions, cam))[0] < 0.0f);
+        t = select(inside, safe_start, t);
+    }
 
-    vec<8> distance, texture, t(1.0f), collided(0.0f), col_mask(0.0f);
+    // rays starting past max_dist, as those of cones which found nothing, are misses
+    escaped = t >= config->max_dist;
 
     for (int s = 0; s < config->max_its; s++) {
         tpack = t;
@@ -193,66 +282,304 @@ vecpack<8, 2> Shader::march_simd(const float gt, const vecpack<8, 3>& directions
         distance = res[0];
         texture = res[1];
 
+        active = ~(hit | escaped);
+
+        // relaxed steps which may have skipped over a surface are replaced by plain ones
+        failed = active & (omega > 1.0f) & (distance + previous < step);
+        t = masked_add(failed, t, previous - step);
+        omega = select(failed, 1.0f, omega);
+        active = active & ~failed;
+
         collided = distance < 0.0005 * t;
-        col_mask = max(col_mask, collided);
+        hit = hit | (active & collided);
 
-        t = mul_add(distance, (1.0 - col_mask), t);
+        previous = select(active, distance, previous);
+        step = omega * distance;
+        t = masked_add(active & ~collided, t, step);
+        escaped = escaped | (t >= config->max_dist);
 
-        if (sum(col_mask) == 8) break;
+        if (all(hit | escaped)) break;
     }
 
     // t = -1 if no collision, else distance
-    t = mul_add(col_mask, t, col_mask - 1.0f);
-    texture = col_mask * texture;
+    t = select(hit, t, -1.0f);
+    texture = select(hit, texture, 0.0f);
+
+    return vecpack<simd_width, 2>({t, texture});
+}
+
+template<typename SceneType>
+template<size_t max_packs>
+void Shader<SceneType>::march_stream_simd(size_t num_packs, const std::array<vecpack<simd_width, 2>, max_packs>& pixels,
+                               const std::array<vec<simd_width>, max_packs>& start, const std::array<float, max_packs>& safe_start,
+                               std::array<vec<simd_width>, max_packs>& hit_time, std::array<vec<simd_width>, max_packs>& hit_texture) const {
+    // the ray i is the lane i % simd_width of the pack i / simd_width
+    std::array<std::array<float, simd_width>, max_packs> ray_x, ray_y, ray_z, ray_start, ray_t, ray_texture;
+    for (size_t pack = 0; pack < num_packs; pack++) {
+        vecpack<simd_width, 3> dir = camera->get_ray_dir_simd(pixels[pack]);
+        ray_x[pack] = dir[0];
+        ray_y[pack] = dir[1];
+        ray_z[pack] = dir[2];
+        ray_start[pack] = start[pack];
+    }
 
-    return vecpack<8, 2>({t, texture});
+    // Lanes live in registers and are only spilled to their arrays when one of them is done.
+    // A lane probes on its first step whether a guessed start put its ray inside a surface.
+    const size_t num_rays = simd_width * num_packs;
+    size_t next_ray = 0;
+    std::array<size_t, simd_width> lane_ray;
+    std::array<float, simd_width> lane_x, lane_y, lane_z, lane_t, lane_safe, lane_its;
+    std::array<float, simd_width> lane_omega, lane_step, lane_previous, lane_texture;
+    // the lane predicates are kept as bits, bit i for lane i
+    unsigned int lane_probe = 0, lane_live = 0, lane_hit = 0, lane_done = 0;
+
+    auto refill = [&](size_t lane) {
+        const unsigned int bit = 1u << lane;
+        lane_hit &= ~bit;
+        lane_done &= ~bit;
+        lane_probe &= ~bit;
+        lane_live &= ~bit;
+
+        // rays starting past max_dist, as those of cones which found nothing, are misses
+        while (next_ray < num_rays && ray_start[next_ray / simd_width][next_ray % simd_width] >= config->max_dist) {
+            ray_t[next_ray / simd_width][next_ray % simd_width] = -1.0f;
+            ray_texture[next_ray / simd_width][next_ray % simd_width] = 0.0f;
+            next_ray++;
+        }
+
+        if (next_ray == num_rays) return;
+
+        const size_t pack = next_ray / simd_width, i = next_ray % simd_width;
+        lane_ray[lane] = next_ray++;
+        lane_x[lane] = ray_x[pack][i];
+        lane_y[lane] = ray_y[pack][i];
+        lane_z[lane] = ray_z[pack][i];
+        lane_t[lane] = ray_start[pack][i];
+        lane_safe[lane] = safe_start[pack];
+        lane_its[lane] = 0.0f;
+        if (ray_start[pack][i] > safe_start[pack]) lane_probe |= bit;
+        lane_live |= bit;
+        lane_omega[lane] = config->relaxation;
+        lane_step[lane] = lane_previous[lane] = 0.0f;
+    };
+
+    for (size_t lane = 0; lane < simd_width; lane++) refill(lane);
+
+    vecpack<simd_width, 2> res;
+    vecpack<simd_width, 3> cam(camera->position), directions, tpack;
+    vec<simd_width> distance, t, safe, its, omega, step, previous;
+    vmask<simd_width> inside, failed, stepping, collided, active, probe, live, hit, done;
+
+    auto load_lanes = [&] {
+        directions[0] = lane_x;
+        directions[1] = lane_y;
+        directions[2] = lane_z;
+        t = lane_t;
+        safe = lane_safe;
+        its = lane_its;
+        probe = vmask<simd_width>::from_bits(lane_probe);
+        live = vmask<simd_width>::from_bits(lane_live);
+        hit = vmask<simd_width>::from_bits(lane_hit);
+        done = vmask<simd_width>::from_bits(lane_done);
+        omega = lane_omega;
+        step = lane_step;
+        previous = lane_previous;
+    };
+
+    load_lanes();
+    while (any(live)) {
+        tpack = t;
+        res = scene->dist_field_simd(config->time, mul_add(tpack, directions, cam));
+        distance = res[0];
+        active = live & ~done;
+
+        // rays found inside march again from their safe start
+        inside = probe & (distance < 0.0f);
+        t = select(inside, safe, t);
+        probe = false;
+
+        // relaxed steps which may have skipped over a surface are replaced by plain ones
+        failed = active & ~inside & (omega > 1.0f) & (distance + previous < step);
+        t = masked_add(failed, t, previous - step);
+        omega = select(failed, 1.0f, omega);
+        stepping = active & ~(inside | failed);
+
+        collided = stepping & (distance < 0.0005 * t);
+        previous = select(stepping, distance, previous);
+        step = select(stepping, omega * distance, step);
+        t = masked_add(stepping & ~collided, t, omega * distance);
+        its = masked_add(active, its, 1.0f);
+
+        hit = hit | collided;
+        done = done | (active & (collided | (t >= config->max_dist) | (its >= config->max_its)));
+
+        // once the stream has run dry, done lanes wait frozen for the others
+        const int num_done = count(done);
+        if (num_done == 0 || (next_ray == num_rays && num_done < count(live))) continue;
+
+        lane_t = t;
+        lane_its = its;
+        lane_probe = bits(probe);
+        lane_omega = omega;
+        lane_step = step;
+        lane_previous = previous;
+        lane_texture = res[1];
+        lane_hit = bits(hit);
+        lane_done = bits(done);
+
+        for (size_t lane = 0; lane < simd_width; lane++) {
+            if (!(lane_done >> lane & 1)) continue;
+
+            const size_t ray = lane_ray[lane];
+            const bool lane_collided = lane_hit >> lane & 1;
+            ray_t[ray / simd_width][ray % simd_width] = lane_collided ? lane_t[lane] : -1.0f;
+            ray_texture[ray / simd_width][ray % simd_width] = lane_collided ? lane_texture[lane] : 0.0f;
+            refill(lane);
+        }
+
+        load_lanes();
+    }
+
+    for (size_t pack = 0; pack < num_packs; pack++) {
+        hit_time[pack] = ray_t[pack];
+        hit_texture[pack] = ray_texture[pack];
+    }
 }
 
-float Shader::shadow(const float gt, const vec3& p, int k) const {
+template<typename SceneType>
+vec<simd_width> Shader<SceneType>::cone_march_simd(const vecpack<simd_width, 2>& centers, const vec<simd_width>& radius, const vec<simd_width>& start) const {
+    vecpack<simd_width, 3> axes = camera->get_ray_dir_simd(centers), cam(camera->position), tpack;
+
+    // the pixels are seen at an angle of at most radius / focal length from the axis,
+    // a bit less away from the center of the screen
+    vec<simd_width> spread = radius / camera->focal_length();
+    vec<simd_width> distance, t(start);
+    vmask<simd_width> done = t >= config->max_dist;
+
+    for (int s = 0; s < config->max_its && !all(done); s++) {
+        tpack = t;
+        distance = scene->dist_field_simd(config->time, mul_add(tpack, axes, cam))[0];
+
+        // the cone's cross section, of radius t * spread, is free as long as it fits in the
+        // distance bound. Like the rays, this takes the field to be 1-Lipschitz: the bound
+        // shrinks by at most one for every unit moved along the axis.
+        vec<simd_width> clearance = distance - t * spread;
+        done = done | (clearance < 0.0005 * t);
+
+        t = select(done, t, mul_add(clearance, 1.0f / (1.0f + spread), t));
+        done = done | (t >= config->max_dist);
+    }
+
+    return min(t, config->max_dist);
+}
+
+template<typename SceneType>
+float Shader<SceneType>::interval_march(const vec2& center, float radius, float start) const {
+    // the rays are at an angle of at most radius / focal length from the axis, as for the cones,
+    // their directions then differ from the axis by at most as much along any coordinate
+    const vec3 axis = camera->get_ray_dir(center);
+    const float spread = radius / camera->focal_length();
+    intervalpack<3> directions;
+    for (size_t k = 0; k < 3; k++) directions[k] = interval(axis[k] - spread, axis[k] + spread);
+
+    auto empty = [&](float from, float to) {
+        intervalpack<3> box;
+        for (size_t k = 0; k < 3; k++) box[k] = camera->position[k] + interval(from, to) * directions[k];
+        return scene->dist_field_interval(config->time, box).lo > 0.0f;
+    };
+
+    // the ranges grow while they are empty and shrink when they are not, until too thin to be worth it
+    float t = start, length = start;
+    bool blocked = false;
+    for (int s = 0; s < max_interval_its && t < config->max_dist; s++) {
+        const float end = std::min(t + length, config->max_dist);
+        blocked = !empty(t, end);
+
+        if (!blocked) {
+            t = end;
+            length *= 2.0f;
+        } else {
+            length *= 0.25f;
+            if (length < min_interval_length * t) break;
+        }
+    }
+
+    // the rest of the rays at once, which proves the tiles seeing only sky
+    if (!blocked && t < config->max_dist && empty(t, config->max_dist)) t = config->max_dist;
+
+    return std::min(t, config->max_dist);
+}
+
+template<typename SceneType>
+float Shader<SceneType>::shadow(const float gt, const vec3& p, int k) const {
     float t = 0.01;
     float h;
     float res = 1.0;
     vec2 dres;
+    float omega = config->relaxation, step = 0.0f, plain_step = 0.0f, previous = 0.0f;
 
     for (int s = 0; s < 16 || t < 6.0; s++) {
         dres = scene->dist_field(gt, p + t*config->light_dir);
         h = dres[0];
+
+        if (omega > 1.0f && h + previous < step) {
+            t += plain_step - step;
+            omega = 1.0f;
+            continue;
+        }
+
         res = std::min(res, k*std::max(0.0f, h)/t);
         if (h < 0.0001) {
             res = 0.0;
             break;
         }
         
-        t += std::clamp(h, 0.01f, 0.5f);
+        previous = h;
+        plain_step = std::clamp(h, 0.01f, 0.5f);
+        step = omega * plain_step;
+        t += step;
     }
     
     return res;
 }
 
-vec<8> Shader::shadow_simd(const float gt, const vecpack<8, 3>& p, int k) const {
-    vecpack<8, 3> dir(config->light_dir);
-    vec<8> distance, texture, t(1.0f), collided(0.0f), col_mask(0.0f), res(1.0f);
-
+template<typename SceneType>
+vec<simd_width> Shader<SceneType>::shadow_simd(const float gt, const vecpack<simd_width, 3>& p, int k, const vmask<simd_width>& active) const {
+    vecpack<simd_width, 3> dir(config->light_dir);
+    vec<simd_width> distance, t(1.0f), res(1.0f);
+    vec<simd_width> omega(config->relaxation), step(0.0f), plain_step(0.0f), previous(0.0f);
+    vmask<simd_width> hit = ~active, failed, stepping, collided;
 
     for (int s = 0; s < 16; s++) {
-        vecpack<8, 2> dres = scene->dist_field_simd(gt, p + t * dir);
+        vecpack<simd_width, 2> dres = scene->dist_field_simd(gt, p + t * dir);
         distance = dres[0];
 
-        res = min(res, k*max(0.0f, distance)/t);
+        // relaxed steps which may have skipped over an occluder are replaced by plain ones
+        failed = ~hit & (omega > 1.0f) & (distance + previous < step);
+        t = masked_add(failed, t, plain_step - step);
+        omega = select(failed, 1.0f, omega);
+        stepping = ~(hit | failed);
+
+        res = select(stepping, min(res, k*max(0.0f, distance)/t), res);
 
-        collided = distance < 0.0001;
-        col_mask = max(col_mask, collided);
+        collided = stepping & (distance < 0.0001);
+        hit = hit | collided;
 
-        t = t + (1.0 - col_mask) * clamp(distance, 0.01f, 0.5f);
+        vec<simd_width> clamped = clamp(distance, 0.01f, 0.5f);
+        previous = select(stepping, distance, previous);
+        plain_step = select(stepping, clamped, plain_step);
+        step = omega * plain_step;
+        t = masked_add(stepping & ~collided, t, omega * clamped);
 
-        if (sum(col_mask) == 8) break;
+        if (all(hit)) break;
     }
 
     // res = 0.0f if collision, else res
-    return (1.0f - col_mask) * res;
+    return select(hit, 0.0f, res);
 }
 
-vec3 Shader::apply_fog(const vec3& original_color, float distance, const vec3& ray_dir, const vec3& sun_dir) const {
+template<typename SceneType>
+vec3 Shader<SceneType>::apply_fog(const vec3& original_color, float distance, const vec3& ray_dir, const vec3& sun_dir) const {
     float fog = 1.0 - exp(-powf(distance/40.0f, 2));
     float sun = std::max(dot(ray_dir, sun_dir), 0.0f);
     vec3 fog_color = interp(
@@ -263,12 +590,13 @@ vec3 Shader::apply_fog(const vec3& original_color, float distance, const vec3& r
     return interp(fog_color, original_color, fog);
 }
 
-vecpack<8, 3> Shader::apply_fog_simd(const vecpack<8, 3>& original_color, vec<8> distance, const vecpack<8, 3>& ray_dir, const vecpack<8, 3>& sun_dir) const {
-    vec<8> scaled_dist = distance/40.0f;
-    vec<8> fog = 1.0 - exp(-scaled_dist*scaled_dist);
+template<typename SceneType>
+vecpack<simd_width, 3> Shader<SceneType>::apply_fog_simd(const vecpack<simd_width, 3>& original_color, vec<simd_width> distance, const vecpack<simd_width, 3>& ray_dir, const vecpack<simd_width, 3>& sun_dir) const {
+    vec<simd_width> scaled_dist = distance/40.0f;
+    vec<simd_width> fog = 1.0 - exp(-scaled_dist*scaled_dist);
 
-    vec<8> sun = max(dot(ray_dir, sun_dir), 0.0f);
-    vecpack<8, 3> fog_color = interp(
+    vec<simd_width> sun = max(dot(ray_dir, sun_dir), 0.0f);
+    vecpack<simd_width, 3> fog_color = interp(
         vec3(1.0,0.9,0.7), // sun yellow-ish
         vec3(0.5, 0.6, 0.7), // sky blue-ish
         sun
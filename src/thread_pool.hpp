@@ -0,0 +1,164 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of workers running batches of indexed jobs. Each worker owns a deque
+// seeded with a contiguous range of the batch; it pops from the front of its own
+// deque and, once empty, steals from the back of the others' deques.
+class ThreadPool {
+    public:
+    ThreadPool(size_t num_threads);
+    ~ThreadPool();
+
+    // runs job(0), ..., job(num_jobs - 1) on the workers and blocks until all are done
+    void run(size_t num_jobs, const std::function<void(size_t)>& job);
+
+    // same as run, but returns immediately, wait() blocks until the batch is done
+    void dispatch(size_t num_jobs, const std::function<void(size_t)>& job);
+    void wait();
+
+    size_t size() const;
+
+    private:
+    struct job_queue {
+        std::mutex mutex;
+        std::deque<size_t> jobs;
+    };
+
+    void work(size_t worker);
+    bool pop(size_t worker, size_t& job);
+    bool steal(size_t worker, size_t& job);
+
+    std::vector<std::thread> threads;
+    std::vector<std::unique_ptr<job_queue>> queues;
+
+    std::function<void(size_t)> current_job;
+    std::atomic<size_t> remaining_jobs;
+
+    std::mutex mutex;
+    std::condition_variable wake_workers, batch_done;
+    size_t batch;
+    bool stopping;
+};
+
+ThreadPool::ThreadPool(size_t num_threads) : remaining_jobs(0), batch(0), stopping(false) {
+    num_threads = std::max<size_t>(num_threads, 1);
+
+    for (size_t i = 0; i < num_threads; i++) {
+        queues.push_back(std::make_unique<job_queue>());
+    }
+    for (size_t i = 0; i < num_threads; i++) {
+        threads.emplace_back(&ThreadPool::work, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake_workers.notify_all();
+
+    for (auto& thread : threads) thread.join();
+}
+
+size_t ThreadPool::size() const {
+    return threads.size();
+}
+
+void ThreadPool::run(size_t num_jobs, const std::function<void(size_t)>& job) {
+    dispatch(num_jobs, job);
+    wait();
+}
+
+void ThreadPool::dispatch(size_t num_jobs, const std::function<void(size_t)>& job) {
+    // only one batch can be in flight
+    wait();
+    if (num_jobs == 0) return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        current_job = job;
+        remaining_jobs = num_jobs;
+    }
+
+    // the job must be published before the queues are filled, a worker still
+    // draining the previous batch may pick up new jobs without waiting
+    const size_t num_workers = queues.size();
+    for (size_t i = 0; i < num_workers; i++) {
+        std::lock_guard<std::mutex> lock(queues[i]->mutex);
+        for (size_t j = i * num_jobs / num_workers; j < (i + 1) * num_jobs / num_workers; j++) {
+            queues[i]->jobs.push_back(j);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        batch++;
+    }
+    wake_workers.notify_all();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    batch_done.wait(lock, [this] { return remaining_jobs == 0; });
+}
+
+void ThreadPool::work(size_t worker) {
+    size_t seen_batch = 0;
+    size_t job;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake_workers.wait(lock, [&] { return stopping || batch != seen_batch; });
+            if (stopping) return;
+            seen_batch = batch;
+        }
+
+        while (pop(worker, job) || steal(worker, job)) {
+            current_job(job);
+
+            if (--remaining_jobs == 0) {
+                std::lock_guard<std::mutex> lock(mutex);
+                batch_done.notify_all();
+            }
+        }
+    }
+}
+
+bool ThreadPool::pop(size_t worker, size_t& job) {
+    job_queue& queue = *queues[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.jobs.empty()) return false;
+
+    job = queue.jobs.front();
+    queue.jobs.pop_front();
+    return true;
+}
+
+bool ThreadPool::steal(size_t worker, size_t& job) {
+    const size_t num_workers = queues.size();
+
+    for (size_t i = 1; i < num_workers; i++) {
+        job_queue& queue = *queues[(worker + i) % num_workers];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.jobs.empty()) continue;
+
+        job = queue.jobs.back();
+        queue.jobs.pop_back();
+        return true;
+    }
+    return false;
+}
+
+#endif
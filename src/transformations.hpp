@@ -1,7 +1,14 @@
 #ifndef TRANSFORMATIONS_H
 #define TRANSFORMATIONS_H
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <type_traits>
+
 #include "linalg/vec.hpp"
+#include "linalg/dual.hpp"
+#include "linalg/interval.hpp"
 
 float smin(float a, float b, float k) {
     float h = fmax(k-abs(a-b), 0.0f)/k;
@@ -14,58 +21,195 @@ vec<N> smin(const vec<N>& a, const vec<N>& b, float k) {
     return min(a, b) - h*h*k*(1.0/6.0);
 }
 
+template<size_t N>
+dual<N> smin(const dual<N>& a, const dual<N>& b, float k) {
+    dual<N> h = max(k-abs(a-b), 0.0f)/k;
+    return min(a, b) - h*h*k*(1.0/6.0);
+}
+
+// the blend takes at most k / 6 off the min
+interval smin(const interval& a, const interval& b, float k) {
+    const interval m = min(a, b);
+    return interval(m.lo - k * (1.0f / 6.0f), m.hi);
+}
+
 vec3 translate(const vec3& d, const vec3& p) {
     return p - d;
 }
 
-vec3 symX(const vec3& p) {
-    vec3 q = p;
-    q[0] = abs(p[0]);
+// The operators below move a point, a vecpack or a dualpack of points, in the domain of a
+// single instance: the distance to its instances is then that to the one instance. The cells
+// are found from the values of the points, the gradients of dual points go through unchanged.
+
+enum Axis { axis_x = 1, axis_y = 2, axis_z = 4 };
+
+// p mirrored onto the positive side of the axes, a set of Axis flags
+template<typename point>
+point symAxes(unsigned axes, const point& p) {
+    using std::abs;
+    point q = p;
+    for (size_t k = 0; k < 3; k++) {
+        if (axes & (1u << k)) q[k] = abs(p[k]);
+    }
     return q;
 }
 
-vec3 symXZ(const vec3& p) {
-    vec3 q = p;
-    q[0] = abs(p[0]);
-    q[2] = abs(p[2]);
+template<typename point>
+point symX(const point& p) {
+    return symAxes(axis_x, p);
+}
+
+template<typename point>
+point symXZ(const point& p) {
+    return symAxes(axis_x | axis_z, p);
+}
+
+// index of the cell of the given period holding x, the cell 0 being centered on the origin
+float cellIndex(float x, float period) {
+    return std::floor(x / period + 0.5f);
+}
+
+template<size_t N>
+vec<N> cellIndex(const vec<N>& x, float period) {
+    return floor(mul_add(x, vec<N>(1.0f / period), vec<N>(0.5f)));
+}
+
+template<size_t N>
+vec<N> cellIndex(const dual<N>& x, float period) {
+    return cellIndex(x.value, period);
+}
+
+// the cells overlapped by x
+interval cellIndex(const interval& x, float period) {
+    return floor(x * (1.0f / period) + 0.5f);
+}
+
+// the cell next to index on the side of x
+float neighbourCell(float x, float period, float index) {
+    return x >= period * index ? index + 1.0f : index - 1.0f;
+}
+
+template<size_t N>
+vec<N> neighbourCell(const vec<N>& x, float period, const vec<N>& index) {
+    return index + select(x >= period * index, vec<N>(1.0f), vec<N>(-1.0f));
+}
+
+template<size_t N>
+vec<N> neighbourCell(const dual<N>& x, float period, const vec<N>& index) {
+    return neighbourCell(x.value, period, index);
+}
+
+interval neighbourCell(const interval& x, float period, const interval& index) {
+    return interval(index.lo - 1.0f, index.hi + 1.0f);
+}
+
+// p moved from the given cells to the cell around the origin, along the axes whose period is not 0
+template<typename point, typename cells>
+point toCell(const vec3& period, const cells& index, const point& p) {
+    point q = p;
+    for (size_t k = 0; k < 3; k++) {
+        if (period[k] != 0.0f) q[k] = p[k] - period[k] * index[k];
+    }
     return q;
 }
 
+// p repeated every period along the axes whose period is not 0
+template<typename point>
+point repeatAxes(const vec3& period, const point& p) {
+    using cell = decltype(cellIndex(p[0], 1.0f));
+    std::array<cell, 3> index;
+    for (size_t k = 0; k < 3; k++) index[k] = period[k] != 0.0f ? cellIndex(p[k], period[k]) : cell(0.0f);
+    return toCell(period, index, p);
+}
+
+// p repeated over the cells -limit to limit, the points beyond going to the outermost cells
+template<typename point>
+point repeatBounded(const vec3& period, const vec3& limit, const point& p) {
+    using std::clamp;
+    using cell = decltype(cellIndex(p[0], 1.0f));
+    std::array<cell, 3> index;
+    for (size_t k = 0; k < 3; k++) {
+        index[k] = period[k] != 0.0f ? clamp(cellIndex(p[k], period[k]), -limit[k], limit[k]) : cell(0.0f);
+    }
+    return toCell(period, index, p);
+}
+
+// angle of the middle of the sector holding (x, z), out of count sectors around the y axis
+float polarSector(float count, float x, float z) {
+    const float sector = 2.0f * M_PI / count;
+    return sector * std::floor(std::atan2(z, x) / sector + 0.5f);
+}
+
 template<size_t N>
-vecpack<N, 3> repeatX(float pattern, const vecpack<N, 3>& p) {
-    return vecpack<N, 3>({
-        (p[0] + 0.5f * pattern) % pattern  - 0.5f * pattern,
-        p[1],
-        p[2],
-    });
+vec<N> polarSector(float count, const vec<N>& x, const vec<N>& z) {
+    const float sector = 2.0f * M_PI / count;
+    return sector * floor(mul_add(atan2(z, x), vec<N>(1.0f / sector), vec<N>(0.5f)));
+}
+
+// p repeated count times around the y axis, the sector around the x axis holding the instance
+template<typename point>
+point repeatPolar(float count, const point& p) {
+    const auto angle = polarSector(count, value_of(p[0]), value_of(p[2]));
+    std::decay_t<decltype(angle)> s, c;
+    sincos(angle, s, c);
+
+    // rotated by -angle
+    point q = p;
+    q[0] = c * p[0] + s * p[2];
+    q[2] = c * p[2] - s * p[0];
+    return q;
 }
 
-vec3 repeatX(float pattern, const vec3& p) {
-    return {
-        fmodf(p[0] + 0.5f * pattern, pattern) - 0.5f * pattern,
-        p[1],
-        p[2],
-    };
+// the sectors overlapped by the box may not be known: the box is taken to whatever part of the
+// sector around the x axis is within its range of distances to the y axis
+intervalpack<3> repeatPolar(float count, const intervalpack<3>& p) {
+    const float half_sector = M_PI / count;
+    const interval r = sqrt(sqr(p[0]) + sqr(p[2]));
+
+    intervalpack<3> q = p;
+    if (half_sector >= 0.5f * M_PI) {
+        q[0] = q[2] = interval(-r.hi, r.hi);
+    } else {
+        q[0] = interval(r.lo * std::cos(half_sector), r.hi);
+        q[2] = interval(-r.hi * std::sin(half_sector), r.hi * std::sin(half_sector));
+    }
+    return q;
 }
 
-vec3 repeatXZ(const vec2& pattern, const vec3& p) {
-    return {
-        fmodf(p[0] + 0.5f * pattern[0], pattern[0]) - 0.5f * pattern[0],
-        p[1],
-        fmodf(p[2] + 0.5f * pattern[1], pattern[1]) - 0.5f * pattern[1],
-    };
+template<typename point>
+point repeatX(float pattern, const point& p) {
+    return repeatAxes(vec3(pattern, 0.0f, 0.0f), p);
 }
 
-vec3 repeatXY(const vec2& pattern, const vec3& p) {
-    return {
-        fmodf(p[0] + 0.5f * pattern[0], pattern[0]) - 0.5f * pattern[0],
-        fmodf(p[1] + 0.5f * pattern[1], pattern[1]) - 0.5f * pattern[1],
-        p[2],
-    };
+template<typename point>
+point repeatXZ(const vec2& pattern, const point& p) {
+    return repeatAxes(vec3(pattern[0], 0.0f, pattern[1]), p);
+}
+
+template<typename point>
+point repeatXY(const vec2& pattern, const point& p) {
+    return repeatAxes(vec3(pattern[0], pattern[1], 0.0f), p);
 }
 
 float displacement(const vec3& p) {
     return sin(20*p[0])*sin(20*p[1])*sin(20*p[2]);
 }
 
+template<size_t N>
+vec<N> displacement(const vecpack<N, 3>& p) {
+    return sin(20.0f * p[0]) * sin(20.0f * p[1]) * sin(20.0f * p[2]);
+}
+
+template<size_t N>
+dual<N> displacement(const dualpack<N, 3>& p) {
+    return sin(20.0f * p[0]) * sin(20.0f * p[1]) * sin(20.0f * p[2]);
+}
+
+interval displacement(const intervalpack<3>& p) {
+    return interval(-1.0f, 1.0f);
+}
+
+// the steepest slope of the displacement, 20 sqrt(3)
+constexpr float displacement_slope = 34.65f;
+
 #endif
\ No newline at end of file